@@ -0,0 +1,370 @@
+// Throughput benchmark for locjson, which can also be built against the migration shims so that
+// the cost of staying on locjson can be compared with switching backends.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 bench/locjson_bench.cpp -o locjson_bench
+//   g++ -std=c++17 -O2 -DBENCH_RAPIDJSON -I<rapidjson>/include bench/locjson_bench.cpp -o rapidjson_bench
+//   g++ -std=c++17 -O2 -DBENCH_CPPREST bench/locjson_bench.cpp -lcpprest -o cpprest_bench
+//   ./locjson_bench [scale]
+//
+// Every corpus is generated locally. For each workload the output shows MB/s over the input (or
+// output, for the builder), ns per operation, and heap allocations per operation. Streaming
+// export also reports records per second.
+// "load" is the work needed before the document can be queried: a DOM parse for the shims, and
+// Validate for locjson (whose Parse is free, as lookups scan the text lazily).
+
+#if defined(BENCH_RAPIDJSON)
+# include "../migration/locjson_to_rapidjson.h"
+#elif defined(BENCH_CPPREST)
+# include "../migration/locjson_to_cpprest.h"
+#else
+# define LOCJSON_IMPLEMENTATION
+# include "../locjson.h"
+#endif
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Allocation counting
+//------------------------------------------------------------------------------
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+# pragma GCC diagnostic ignored "-Wmismatched-new-delete" // new/delete are replaced below with malloc/free as a matched pair
+#endif
+static std::atomic<unsigned long long> g_allocations(0);
+void* operator new(size_t size)
+{
+	++g_allocations;
+	if( void* p = malloc(size ? size : 1) ) { return p; }
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept              { free(p); }
+void operator delete(void* p, size_t) noexcept      { free(p); }
+void* operator new[](size_t size)                   { return operator new(size); }
+void operator delete[](void* p) noexcept            { free(p); }
+void operator delete[](void* p, size_t) noexcept    { free(p); }
+
+//------------------------------------------------------------------------------
+// Backend adapters: everything that differs between locjson.h and the shims
+//------------------------------------------------------------------------------
+namespace backend
+{
+#if defined(BENCH_RAPIDJSON)
+	const char* name = "rapidjson";
+	#define K(x) x
+	typedef rapidjson::Document Document;
+	inline bool Load(const std::string& text, Document& doc) { doc.Parse(text.c_str(), text.size()); return !doc.HasParseError(); }
+	inline size_t BuilderSize(locjson::JSONBuilder& b) { return b.buf.GetSize(); }
+	inline void ResetBuilder(locjson::JSONBuilder& b) { locjson::Reset(b); }
+#elif defined(BENCH_CPPREST)
+	const char* name = "cpprest";
+	#define K(x) L ## x
+	typedef web::json::value Document;
+	inline bool Load(const std::string& text, Document& doc) { doc = web::json::value::parse(utility::conversions::to_string_t(text)); return true; }
+	inline size_t BuilderSize(locjson::JSONBuilder& b) { return b.serialize().size(); }
+	inline void ResetBuilder(locjson::JSONBuilder& b) { b = web::json::value::object(); }
+#else
+	const char* name = "locjson";
+	#define K(x) x
+	struct Document { locjson::JSONValue root; }; // a view, so the text must outlive it
+	inline bool Load(const std::string& text, Document& doc)
+	{
+		locjson::JSONTrusted trusted;
+		locjson::JSONParseError error;
+		doc.root = locjson::Parse(text.data(), text.size());
+		return locjson::Validate(doc.root, trusted, error);
+	}
+	inline locjson::JSONValue Root(const Document& doc) { return doc.root; }
+	inline size_t BuilderSize(locjson::JSONBuilder& b) { return b.size; }
+	inline void ResetBuilder(locjson::JSONBuilder& b) { locjson::Reset(b); }
+#endif
+#if defined(BENCH_RAPIDJSON) || defined(BENCH_CPPREST)
+	inline const Document& Root(const Document& doc) { return doc; }
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Corpora
+//------------------------------------------------------------------------------
+static std::string DeepNesting(int depth, int copies)
+{
+	std::string doc = "[";
+	for(int c=0; c<copies; ++c)
+	{
+		if( c ) { doc += ","; }
+		for(int d=0; d<depth; ++d) { doc += d & 1 ? "[" : "{\"k\":"; }
+		doc += "1";
+		for(int d=depth-1; d>=0; --d) { doc += d & 1 ? "]" : "}"; }
+	}
+	return doc + "]";
+}
+static std::string WideObject(int fields)
+{
+	std::string doc = "{";
+	for(int f=0; f<fields; ++f)
+		doc += (f ? ",\"field" : "\"field") + std::to_string(f) + "\":" + std::to_string(f * 7);
+	return doc + "}";
+}
+static std::string NumericArray(int count)
+{
+	std::string doc = "{\"values\":[";
+	char number[32];
+	for(int i=0; i<count; ++i)
+	{
+		snprintf(number, sizeof(number), i % 3 ? "%s%d.%03d" : "%s%d", i ? "," : "", i * 13 % 100000, i % 1000);
+		doc += number;
+	}
+	return doc + "]}";
+}
+static std::string Strings(int count, bool escapes)
+{
+	std::string doc = "{\"strings\":[";
+	for(int i=0; i<count; ++i)
+	{
+		doc += i ? ",\"" : "\"";
+		doc += escapes ? "line\\none \\\"quoted\\\" tab\\t back\\\\slash \\u00e9\\u4e2d " : "a plain string without any escape sequences at all, ";
+		doc += std::to_string(i) + "\"";
+	}
+	return doc + "]}";
+}
+static std::string Pretty(int count)
+{
+	std::string doc = "{\n  \"records\": [";
+	for(int i=0; i<count; ++i)
+		doc += (i ? ",\n    {\n" : "\n    {\n") + std::string("      \"id\": ") + std::to_string(i) + ",\n      \"name\": \"record \\\"" + std::to_string(i) +
+		       "\\\"\",\n      \"tags\": [ \"a\", \"b\" ]\n    }";
+	return doc + "\n  ]\n}\n";
+}
+static std::string Lines(int count)
+{
+	std::string doc;
+	for(int i=0; i<count; ++i)
+		doc += "{\"id\":" + std::to_string(i) + ",\"user\":\"user" + std::to_string(i % 97) + "\",\"latency\":" + std::to_string(i % 250) + ".5,\"tags\":[\"a\",\"b\"]}\n";
+	return doc;
+}
+
+//------------------------------------------------------------------------------
+// Measurement
+//------------------------------------------------------------------------------
+static volatile double g_sink;
+template<class F> static double Measure(const char* workload, size_t bytes, size_t operations, F run)
+{
+	run();//warm up
+	int repeats = 0;
+	unsigned long long allocations = g_allocations;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double seconds = 0;
+	do
+	{
+		run();
+		++repeats;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	} while( seconds < 0.5 );
+	allocations = g_allocations - allocations;
+	double ops = (double)operations * repeats;
+	printf("  %-28s | %10.1f | %12.1f | %10.2f\n", workload, (double)bytes * repeats / seconds / 1e6, seconds * 1e9 / ops, (double)allocations / ops);
+	return ops / seconds;
+}
+
+int main(int argc, char** argv)
+{
+	using namespace locjson;
+	int scale = argc > 1 ? atoi(argv[1]) : 1;
+	if( scale < 1 ) { scale = 1; }
+
+	const std::string deep    = DeepNesting(500, 20 * scale);
+	const std::string wide    = WideObject(2000 * scale);
+	const std::string numbers = NumericArray(200000 * scale);
+	const std::string plain   = Strings(20000 * scale, false);
+	const std::string escaped = Strings(20000 * scale, true);
+	const std::string lines   = Lines(50000 * scale);
+
+	printf("%s\n", backend::name);
+	printf("  %-28s | %10s | %12s | %10s\n", "workload", "MB/s", "ns/op", "allocs/op");
+
+	struct Corpus { const char* name; const std::string* text; } corpora[] = {
+		{ "load deep nesting", &deep }, { "load wide object", &wide }, { "load numeric array", &numbers },
+		{ "load plain strings", &plain }, { "load escaped strings", &escaped },
+	};
+	for(const Corpus& c : corpora)
+		Measure(c.name, c.text->size(), 1, [&]() { backend::Document doc; g_sink = backend::Load(*c.text, doc); });
+
+	{
+		backend::Document doc;
+		backend::Load(wide, doc);
+		const int fields = 2000 * scale;
+		std::vector<std::string> keys;
+		for(int f=0; f<fields; f += 97)
+			keys.push_back("field" + std::to_string(f));
+#if defined(BENCH_CPPREST)
+		std::vector<std::wstring> wideKeys(keys.begin(), keys.end());
+		#define KEY(i) wideKeys[i].c_str()
+#else
+		#define KEY(i) keys[i].c_str()
+#endif
+		Measure("field lookup (wide object)", wide.size() / 2 * keys.size(), keys.size(), [&]()
+		{
+			bool error = false;
+			long long sum = 0;
+			for(size_t k=0; k<keys.size(); ++k)
+				sum += LookupInt32(backend::Root(doc), KEY(k), error);
+			g_sink = (double)sum;
+		});
+	}
+	{
+		backend::Document doc;
+		backend::Load(numbers, doc);
+		Measure("array iteration (numbers)", numbers.size(), 200000 * (size_t)scale, [&]()
+		{
+			bool error = false;
+			double sum = 0;
+			auto values = LookupArray(backend::Root(doc), K("values"), error);
+			for(const auto& e : IterateArray(values, error))
+				sum += AsDouble(e, error);
+			g_sink = sum;
+		});
+	}
+	{
+		backend::Document doc;
+		backend::Load(escaped, doc);
+		Measure("string decode (escaped)", escaped.size(), 20000 * (size_t)scale, [&]()
+		{
+			bool error = false;
+			size_t total = 0;
+			auto strings = LookupArray(backend::Root(doc), K("strings"), error);
+			for(const auto& e : IterateArray(strings, error))
+				total += AsString(e, error).size();
+			g_sink = (double)total;
+		});
+	}
+	{
+		//ndjson: split into lines, load each record, read one field
+		Measure("ndjson records", lines.size(), 50000 * (size_t)scale, [&]()
+		{
+			bool error = false;
+			long long sum = 0;
+			backend::Document doc;
+			std::string line;
+			for(size_t begin = 0, end; (end = lines.find('\n', begin)) != std::string::npos; begin = end + 1)
+			{
+				line.assign(lines, begin, end - begin);
+				backend::Load(line, doc);
+				sum += LookupInt32(backend::Root(doc), K("id"), error);
+			}
+			g_sink = (double)sum;
+		});
+#if !defined(BENCH_RAPIDJSON) && !defined(BENCH_CPPREST)
+		Measure("ndjson records (line reader)", lines.size(), 50000 * (size_t)scale, [&]()
+		{
+			bool error = false;
+			long long sum = 0;
+			JSONLineReader reader;
+			OpenLineReader(reader, lines.data(), lines.size());
+			JSONValue record;
+			while( NextRecord(reader, record, error) )
+				sum += LookupInt32(record, "id", error);
+			g_sink = (double)sum;
+		});
+#endif
+	}
+#if !defined(BENCH_RAPIDJSON) && !defined(BENCH_CPPREST)
+	{
+		const std::string pretty = Pretty(50000 * scale);
+		std::vector<Char> minified(pretty.size());
+		Measure("minify (pretty)", pretty.size(), 1, [&]()
+		{
+			bool error = false;
+			g_sink = (double)Minify(JSONValue(pretty.data(), pretty.size()), &minified[0], error);
+		});
+	}
+	{
+		//a large object without escapes: matching each key must stay within the key, or this goes quadratic
+		const std::string flat = WideObject(40000 * scale);
+		const JSONValue root(flat.data(), flat.size());
+		const std::string lastKey = "/field" + std::to_string(40000 * scale - 1);
+		JSONPath last;
+		bool compileError = false;
+		CompilePath(lastKey.c_str(), last, compileError);
+		Measure("path query (flat object)", flat.size(), 1, [&]()
+		{
+			bool error = false;
+			g_sink = (double)QueryPath(root, last, error).size();
+		});
+		JSONEdit edits[] = { EditRemove(lastKey.c_str()) };
+		JSONDocument patched;
+		Measure("edit remove (flat object)", flat.size(), 1, [&]()
+		{
+			bool error = false;
+			ApplyEdits(root, edits, patched, error);
+			g_sink = (double)patched.size();
+		});
+	}
+#endif
+	{
+		JSONBuilder builder;
+		size_t bytes = 0;
+		auto build = [&]()
+		{
+			backend::ResetBuilder(builder);
+			BeginObject(builder);
+			for(int i=0; i<100; ++i)
+			{
+				AddString(builder, K("name"), K("a string value with \"quotes\""));
+				AddInt32(builder, K("id"), i * 12345);
+				AddDouble(builder, K("ratio"), i / 7.0);
+				AddArray(builder, K("list"), 1, 2, 3);
+			}
+			EndObject(builder);
+			bytes = backend::BuilderSize(builder);
+		};
+		build();
+		Measure("builder", bytes, 400, build);
+	}
+#if !defined(BENCH_RAPIDJSON) && !defined(BENCH_CPPREST)
+	{
+		//export: NDJSON records streamed through a fixed buffer to a sink, and to /dev/null with writev
+		const int records = 100000 * scale;
+		auto write = [&](JSONBuilder& b)
+		{
+			for(int i=0; i<records; ++i)
+			{
+				BeginObject(b);
+				AddInt32(b, "id", i);
+				AddString(b, "user", "user name");
+				AddDouble(b, "latency", i / 7.0);
+				AddArray(b, "tags", "a", "b");
+				EndObject(b);
+			}
+		};
+		size_t bytes = 0;
+		JSONSink count = [](void* user, const StringView* parts, int n) { for(int i=0; i<n; ++i) { *(size_t*)user += parts[i].size(); } return true; };
+		{ JSONBuilder b; OpenOutputStream(b, count, &bytes, true); write(b); CloseOutputStream(b); }
+		double perSecond = Measure("ndjson export (sink)", bytes, records, [&]()
+		{
+			size_t written = 0;
+			JSONBuilder b;
+			OpenOutputStream(b, count, &written, true);
+			write(b);
+			g_sink = CloseOutputStream(b);
+		});
+		printf("  %-28s   %.2fM records/s\n", "", perSecond / 1e6);
+		if( FILE* null = fopen("/dev/null", "wb") )
+		{
+			perSecond = Measure("ndjson export (fd)", bytes, records, [&]()
+			{
+				JSONBuilder b;
+				OpenOutputStream(b, fileno(null), true);
+				write(b);
+				g_sink = CloseOutputStream(b);
+			});
+			printf("  %-28s   %.2fM records/s\n", "", perSecond / 1e6);
+			fclose(null);
+		}
+	}
+#endif
+	return 0;
+}
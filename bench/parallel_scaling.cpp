@@ -0,0 +1,88 @@
+// Measures how SplitArray / SplitLines + ParallelForEach scale with the number of threads.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread bench/parallel_scaling.cpp -o parallel_scaling
+//   ./parallel_scaling [megabytes]
+//
+// For each thread count the output shows the throughput of splitting the document into
+// elements, and of splitting + reading one field from every element, plus the speedup over
+// a single thread.
+
+#define LOCJSON_IMPLEMENTATION
+#include "../locjson.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace locjson;
+
+static std::string MakeArray(size_t bytes)
+{
+	std::string doc = "[\n";
+	for(unsigned i=0; doc.size() < bytes; ++i)
+	{
+		if( i ) { doc += ",\n"; }
+		doc += "{\"id\":" + std::to_string(i) + ",\"name\":\"record \\\"" + std::to_string(i) +
+		       "\\\" [with, brackets]\",\"tags\":[\"a\",\"b\",{\"x\":1.5}],\"ok\":true}";
+	}
+	doc += "\n]\n";
+	return doc;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<class Split> static void Run(const char* title, const std::string& doc, Split split)
+{
+	int maxThreads = (int)std::thread::hardware_concurrency();
+	if( maxThreads < 1 ) { maxThreads = 1; }
+	printf("%s, %.0f MB\n", title, doc.size() / 1e6);
+	printf("  threads | split GB/s | speedup | split+read GB/s | speedup\n");
+	double baseSplit = 0, baseRead = 0;
+	for(int threads=1; ; threads = threads*2 > maxThreads && threads != maxThreads ? maxThreads : threads*2)
+	{
+		JSONValue text(doc.data(), doc.size());
+		std::vector<JSONValue> elements;
+		bool error = false;
+		double best = 1e30, bestRead = 1e30;
+		for(int repeat=0; repeat<3; ++repeat)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			split(text, elements, threads, error);
+			double splitTime = Seconds(start);
+			std::atomic<long long> sum(0);
+			ParallelForEach(elements, [&](size_t, const JSONValue& e)
+			{
+				bool fieldError = false;
+				sum += LookupInt32(e, "id", fieldError);
+			}, threads);
+			double readTime = Seconds(start);
+			if( splitTime < best )    { best = splitTime; }
+			if( readTime < bestRead ) { bestRead = readTime; }
+		}
+		if( error ) { printf("  parse error\n"); return; }
+		double gbSplit = doc.size() / best / 1e9, gbRead = doc.size() / bestRead / 1e9;
+		if( threads == 1 ) { baseSplit = gbSplit; baseRead = gbRead; }
+		printf("  %7d | %10.2f | %6.2fx | %15.2f | %6.2fx\n", threads, gbSplit, gbSplit / baseSplit, gbRead, gbRead / baseRead);
+		if( threads == maxThreads ) { break; }
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t megabytes = argc > 1 ? (size_t)atoi(argv[1]) : 256;
+	std::string array = MakeArray(megabytes << 20);
+	Run("Top-level array", array, SplitArray);
+
+	std::string lines = array.substr(2, array.size() - 5);//strip the brackets, leaving one record per line
+	for(size_t i = lines.find(",\n"); i != std::string::npos; i = lines.find(",\n", i))
+		lines[i] = ' ';
+	Run("Newline-delimited", lines, SplitLines);
+	return 0;
+}
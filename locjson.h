@@ -61,23 +61,44 @@
 // Why another no-dependencies single-file C++ JSON parser?
 // I looked at some others and they were up to 20k LOC... This file is:
 //
-//-   ~155 lines of this comment block
-//-   ~130 lines of API declaration + config block
-//-   ~200 lines of implementation
+//-   ~480 lines of this comment block
+//-   ~840 lines of API declaration + config block
+//-   ~2850 lines of implementation
 //
 //------------------------------------------------------------------------------
 // Limitations
 //------------------------------------------------------------------------------
-// The parser should handle any valid JSON document. However, there is currently
-// no API to *retrieve* fractional/floating point numbers, booleans, or null.
+// The parser should handle any valid JSON document. Numbers can be retrieved as
+// 32/64-bit integers or doubles, and `AsBool`/`IsNull` cover the literals.
 //
 // Error reporting will return a flag (or throw an exception if you opt-in) when
-// invalid JSON is detected, but there's no line number reporting or anything 
-// helpful like that.
+// invalid JSON is detected. The regular API only checks the parts of the document
+// that it reads; `Validate` checks the whole document up front, and reports the
+// line and column of the first error.
 //
-// The JSON builder is VERY simple. It only supports a single, non-nested object
-// containing string keys, string values, or array values containing strings or 
-// numbers.
+// Values are skipped, `ParseSax` walks the document and the indexed `Parse`
+// builds its tape with an explicit stack rather than recursion, so hostile input
+// cannot overflow the call stack. Input nested deeper than `LOCJSON_MAX_DEPTH`
+// (512 by default) is reported as an error. `SkipSubtree` is a faster skip that
+// only tracks strings and brackets; defining `LOCJSON_FAST_SKIP` uses it for every
+// value the API passes over, at the cost of not reporting malformed content
+// inside those values.
+//
+// The JSON builder writes compact output into a growable buffer, or a fixed
+// buffer that you supply (`JSONBuilder b(buffer, capacity)`). Objects and arrays
+// can be nested up to 63 deep, strings are escaped, and `Reset` lets a builder
+// be reused without reallocating. Non-finite doubles are written as `null`.
+//
+// To write more output than should be held in memory, `OpenOutputStream` makes
+// the builder send its output to a file descriptor (with `writev`) or a callback
+// through a fixed-size buffer. With `ndjson` set, each top-level value becomes a
+// line, and lines are kept whole within each write where they fit:
+//```
+// locjson::JSONBuilder b;
+// locjson::OpenOutputStream(b, fd, true);
+// for(...) { locjson::BeginObject(b); ...; locjson::EndObject(b); }
+// bool ok = locjson::CloseOutputStream(b);
+//```
 //
 //------------------------------------------------------------------------------
 // API configuration
@@ -89,10 +110,11 @@
 // #define               | typedef               | Default           | Notes
 // LOCJSON_INT32         | locjson::Int32        | int32_t           |
 // LOCJSON_UINT32        | locjson::UInt32       | uint32_t          |
+// LOCJSON_INT64         | locjson::Int64        | int64_t           |
+// LOCJSON_UINT64        | locjson::UInt64       | uint64_t          |
 // LOCJSON_CHAR          | locjson::Char         | char              | See Unicode section
 // LOCJSON_STRING        | locjson::String       | std::string       | Must support construction from `const LOCJSON_CHAR*`
-// LOCJSON_STRING_VIEW   | locjson::StringView   | std::string_view* | *If C++17 is available, else std::string
-// LOCJSON_STRING_STREAM | locjson::StringStream | std::stringstream | 
+// LOCJSON_STRING_VIEW   | locjson::StringView   | std::string_view* | *If C++17 is available, else a minimal view bundled with locjson
 //```
 //
 // The behavior of this header can further be modified by using the following 
@@ -103,6 +125,14 @@
 // LOCJSON_LITERAL(x)         | See Unicode section
 // LOCJSON_FUNCTION           | See Integration section         
 // LOCJSON_IMPLEMENTATION     | See Integration section
+// LOCJSON_NO_SIMD            | Disables SSE2/AVX2 character scanning
+// LOCJSON_NO_MMAP            | Removes OpenMappedFile (for platforms without mmap)
+// LOCJSON_NO_THREADS         | SplitArray/SplitLines/ParallelForEach run on the calling thread
+// LOCJSON_MAX_DEPTH          | Deepest nesting that skipping and ParseSax accept (default 512)
+// LOCJSON_FAST_SKIP          | Values that lookups pass over are skipped by tracking only strings and brackets
+// LOCJSON_STATS              | Enables the per-function counters (see Instrumentation section)
+// LOCJSON_WIDE_UTF8          | Wide keys and strings over UTF-8 documents (see Unicode section)
+// LOCJSON_COMPACT_INPUT      | Every document has been minified, so skipping doesn't look for whitespace
 //```
 //------------------------------------------------------------------------------
 // Integration
@@ -143,12 +173,33 @@
 //```
 // #defien LOCJSON_WIDE
 //```
+//
+// `LOCJSON_WIDE` stores and scans the document as `wchar_t`, so UTF-8 input has to
+// be converted first, into a buffer two to four times larger. Alternatively,
+// `LOCJSON_WIDE_UTF8` keeps the document as UTF-8 and only the API is wide:
+//```
+// #define LOCJSON_WIDE_UTF8
+// ...
+// locjson::JSONValue root = locjson::Parse(utf8Text, utf8Length);
+// std::wstring name = locjson::LookupString(root, L"name", error);
+// int32_t id = locjson::LookupInt32(root, L"id", error);
+//```
+// Lookups with a `wchar_t` key convert the key to UTF-8, and `LookupString` with
+// a `wchar_t` key returns a `std::wstring`. `String`, `JSONDocument` and
+// `JSONBuilder` stay UTF-8 in this mode, so that text read from a document can be
+// written back to a builder unchanged; hence `AsString` still returns UTF-8, and
+// `AsWideString` returns the wide version. Only those wide results are
+// transcoded, by a converter that widens runs of ASCII 16 bytes at a time with
+// SSE2 and decodes other characters one at a time.
+//
 //------------------------------------------------------------------------------
 // C++17
 //------------------------------------------------------------------------------
-// When built on a C++17 compiler, the parser will not perform any memory 
-// allocations. On earlier compilers, the parser will perform a lot of temporary
-// memory allocations...
+// When built on a C++17 compiler, `StringView` is `std::string_view`. On earlier
+// compilers, locjson bundles its own minimal non-owning view with the same
+// subset of the interface (`size`, `data`, `substr`, `compare`, `find_first_of`,
+// ...), so in both cases the parser will not perform any memory allocations.
+// The bundled view converts implicitly to `String` when a copy is wanted.
 //
 // Microsoft Visual Studio reports the wrong value for __cplusplus by default
 // for reasons. To enable C++17 suppport in MSVC, you need to add these compiler
@@ -158,6 +209,290 @@
 //  `/Zc:__cplusplus /std:c++latest`
 //
 //------------------------------------------------------------------------------
+// Indexed parsing
+//------------------------------------------------------------------------------
+// By default `Parse` simply returns a view of the document, and every `Lookup*`,
+// `ArraySize` and `IndexArray` call walks the raw text again. If you read many
+// fields from the same document, you can opt-in to an index instead:
+//```
+// locjson::JSONIndex index;
+// locjson::JSONNode root = locjson::Parse(doc, index, error);
+// int32_t id = locjson::LookupInt32(root, "id", error);
+//```
+// This makes a single pass over the document, recording each value's offsets,
+// child count and next-sibling link in a compact tape. The `JSONNode` overloads
+// of the API then skip nested values in O(1) and `ArraySize` is free.
+// Offsets in the tape are 32-bit, so documents of 4 GiB or more can only be read
+// without an index; `Parse` reports them as an error.
+//
+// For large files that rarely change, the index (with its numbers decoded) can be
+// saved to a binary cache file next to the document, and mapped back in later
+// instead of scanning the text again:
+//```
+// locjson::JSONNode root = locjson::LoadIndexCache(index, file, "data.json.index", true, error);
+// if( !root.index ) // missing, or out of date
+// {
+//   root = locjson::Parse(locjson::Parse(file), index, error);
+//   locjson::SaveIndexCache(index, file, "data.json.index", error);
+// }
+//```
+// A cache is only used if the document's size and modification time match those
+// it was written for (and its content hash, when the `checkHash` argument is
+// true). Every offset, link and child count in the cached tape is checked before
+// use, so a damaged cache is ignored rather than trusted. Modification times have
+// nanosecond precision on Linux, macOS and the BSDs (100ns on Windows) but only
+// whole seconds on other platforms, where `checkHash` should be used if the
+// document may be rewritten within a second. Call `CloseIndexCache(index)` before
+// closing the `JSONMappedFile`.
+//
+//------------------------------------------------------------------------------
+// Iteration
+//------------------------------------------------------------------------------
+// `IndexArray` restarts from the beginning of the array on every call, so a
+// `for(i<ArraySize) IndexArray(i)` loop is O(n^2). Prefer the iterators, which
+// resume from the end of the previous value:
+//```
+// for(locjson::JSONValue e : locjson::IterateArray(array, error)) { ... }
+// for(const locjson::JSONMember& m : locjson::IterateObject(object, error)) { m.key; m.value; }
+//```
+//
+//------------------------------------------------------------------------------
+// Reading several fields
+//------------------------------------------------------------------------------
+// Each `Lookup*` call scans the object from its first member. When reading
+// several fields from the same object, `LookupFields` fills them all in one walk:
+//```
+// locjson::JSONField fields[] = { locjson::FieldInt32("id", id), locjson::FieldString("name", name) };
+// locjson::LookupFields(object, fields, error);
+//```
+// Each field records whether it was `found`, and whether its value had an `error`.
+//
+//------------------------------------------------------------------------------
+// Struct binding
+//------------------------------------------------------------------------------
+// Instead of chains of `Lookup*` calls, a struct's members can be bound to keys
+// once, and then decoded in a single pass over the object:
+//```
+// LOCJSON_BIND_BEGIN(Person)
+//   LOCJSON_BIND_FIELD(id)
+//   LOCJSON_BIND_KEY(address, "addr")
+// LOCJSON_BIND_END()
+//
+// Person p;
+// locjson::JSONBindReport report;
+// locjson::DecodeObject(object, p, error, &report);
+//```
+// Each key in the document costs one hash-table dispatch rather than a compare
+// against every wanted field. Members may be integers, `double`, `bool`, `String`,
+// other bound structs, or `std::vector`s of these. The optional report counts missing
+// and unknown keys. Binding the same key twice is a compile error; keys whose hashes
+// happen to collide still decode correctly, through a slower linear compare.
+//
+//------------------------------------------------------------------------------
+// Strings
+//------------------------------------------------------------------------------
+// `AsString`/`LookupString` decode escape sequences (including `\uXXXX`
+// surrogate pairs) into a new `String`. To avoid the allocation:
+//```
+// locjson::Char buffer[256];
+// locjson::StringView name = locjson::LookupStringView(object, "name", buffer, 256, error);
+//```
+// This returns a view of the document itself when the string has no escapes, and
+// only decodes into `buffer` when it does. `AsRawString` returns the undecoded
+// characters between the quotes, and `UnescapeString` decodes into any buffer.
+//
+//------------------------------------------------------------------------------
+// Memory-mapped documents
+//------------------------------------------------------------------------------
+// Large documents don't need to be copied into a `JSONDocument` first. `Parse`
+// also accepts any caller-owned span of text, or a read-only mapping of a file:
+//```
+// locjson::JSONMappedFile file;
+// if( locjson::OpenMappedFile("data.json", file, error) )
+// {
+//   locjson::JSONValue root = locjson::Parse(file);
+//   ...
+//   locjson::CloseMappedFile(file);
+// }
+//```
+// Every `JSONValue` then points into the mapping, so the file's pages are shared
+// with the OS page cache (and other processes mapping the same file), and no
+// copy of the text is made.
+//
+//------------------------------------------------------------------------------
+// Newline-delimited JSON
+//------------------------------------------------------------------------------
+// Newline-delimited JSON (one document per line) can be read from a `FILE` in
+// fixed-size chunks, or from memory (e.g. a `JSONMappedFile`):
+//```
+// locjson::JSONLineReader reader;
+// locjson::OpenLineReader(reader, file, 1<<20);
+// locjson::JSONValue record;
+// while( locjson::NextRecord(reader, record, error) ) { ... }
+// locjson::JSONLineStats stats = locjson::LineReaderStats(reader);
+//```
+// Newlines inside strings are not treated as record boundaries. Each record is a
+// view of the reader's buffer, valid until the next `NextRecord` call, and is only
+// copied when it straddles two chunks. Memory use is bounded by the chunk size
+// plus the largest record. `LineReaderStats` reports records and bytes per second.
+//
+//------------------------------------------------------------------------------
+// Parallel splitting
+//------------------------------------------------------------------------------
+// Very large top-level arrays, or newline-delimited files, can be split into their
+// elements by several threads at once:
+//```
+// std::vector<locjson::JSONValue> elements;
+// locjson::SplitArray(doc, elements, 0, error); // 0 = one thread per core
+// locjson::ParallelForEach(elements, [&](size_t i, const locjson::JSONValue& e) { results[i] = ...; }, 0);
+//```
+// Each thread scans an equal-sized chunk of the text. Whether a chunk starts
+// inside a string, and at which nesting depth, is resolved with prefix sums over
+// per-chunk quote counts and bracket depths. The elements always come back in
+// document order, regardless of the thread count. `bench/parallel_scaling.cpp`
+// measures the speedup per thread count.
+//
+//------------------------------------------------------------------------------
+// Push parsing
+//------------------------------------------------------------------------------
+// When a document (or a stream of documents) arrives in pieces, e.g. from socket
+// reads, it doesn't need to be assembled first. Push each piece into a
+// `JSONPushParser` as it arrives, and collect the top-level values that have completed:
+//```
+// locjson::JSONPushParser parser;
+// locjson::PushInput(parser, data, length);
+// locjson::JSONValue value;
+// while( locjson::NextValue(parser, value, error) ) { ... }
+// ...
+// locjson::EndInput(parser); // then call NextValue again
+//```
+// The parser keeps its bracket stack and string/escape state between calls, so
+// each character is examined once. Only the value in progress is buffered, and
+// each returned value is a view that stays valid until the next `PushInput`.
+//
+//------------------------------------------------------------------------------
+// Event callbacks (SAX)
+//------------------------------------------------------------------------------
+// To aggregate over a document without building anything, `ParseSax` walks it
+// once and calls a handler for each token. The handler is a template parameter,
+// so its callbacks can be inlined:
+//```
+// struct SumIds : locjson::JSONSaxHandler
+// {
+//   bool isId = false; int64_t sum = 0;
+//   locjson::JSONSaxResult Key(const locjson::StringView& k) { isId = k == "id"; return locjson::JSONContinue; }
+//   locjson::JSONSaxResult Number(const locjson::JSONValue& n) { bool e = false; if( isId ) sum += locjson::AsInt64(n, e); return locjson::JSONContinue; }
+// };
+// SumIds handler;
+// locjson::ParseSax(doc, handler, error);
+//```
+// Each callback returns `JSONContinue` or `JSONStop`, or `JSONSkip` to skip the
+// object/array just started (or the value of the key just seen). Keys and strings
+// are passed raw, without decoding escapes, so no memory is allocated.
+// Each scalar is checked before its callback is made, and text after the root
+// value is an error.
+//
+//------------------------------------------------------------------------------
+// Path queries
+//------------------------------------------------------------------------------
+// Instead of chaining `LookupValue(IndexArray(LookupArray(...)))`, a JSON Pointer
+// (RFC 6901) can be compiled once and evaluated in a single forward scan. A `*`
+// token matches every element of an array (or member of an object):
+//```
+// locjson::JSONPath paths[2];
+// locjson::CompilePath("/items/3/meta/id", paths[0], error);
+// locjson::CompilePath("/items/*/name", paths[1], error);
+// locjson::JSONValue id = locjson::QueryPath(doc, paths[0], error);
+//
+// std::vector<locjson::JSONPathMatch> matches;
+// locjson::QueryPaths(doc, paths, 2, matches, error); // both paths, one scan
+//```
+// Subtrees that no path leads into are skipped whole, and the scan stops as soon
+// as every path without a wildcard has matched. Matches are returned in document order.
+//
+//------------------------------------------------------------------------------
+// Patching
+//------------------------------------------------------------------------------
+// `ApplyEdits` rewrites a document in one pass, e.g. to change a few fields of a
+// large message before forwarding it. The targets of every edit are found in a
+// single path query scan, and everything between them is copied through unchanged:
+//```
+// locjson::JSONEdit edits[] = {
+//   locjson::EditReplace("/user/name", "\"anonymous\""),
+//   locjson::EditRemove("/session/token"),
+//   locjson::EditInsert("/session", "proxied", "true"),
+//   locjson::EditAppend("/hops", "3"),
+// };
+// locjson::JSONDocument out;
+// locjson::ApplyEdits(doc, edits, out, error);
+//```
+// New values are JSON text, such as the output of a `JSONBuilder`. Removing a
+// member or element also removes the comma next to it, and insertions are added
+// to the end of their object or array. An edit inside a value that another edit
+// replaces or removes is an error.
+//
+//------------------------------------------------------------------------------
+// Minifying
+//------------------------------------------------------------------------------
+// `Minify` strips the whitespace outside of strings, 16 characters at a time, either
+// in place or into another buffer of at least the same size. Minified text is
+// smaller to cache or forward, and faster to look values up in:
+//```
+// locjson::Minify(doc, error); // a JSONDocument, in place
+// size_t length = locjson::Minify(text, buffer, error);
+//```
+// If every document the API reads has been minified, defining
+// `LOCJSON_COMPACT_INPUT` makes skipping expect a single comma or colon between
+// values, without scanning for whitespace. Text with whitespace between values
+// (other than before and after the top-level value) is then misread.
+//
+//------------------------------------------------------------------------------
+// Validation
+//------------------------------------------------------------------------------
+// `Validate` strictly checks a whole document once: string escapes, control
+// characters and UTF-8, number syntax, bracket matching, commas and trailing text.
+// On failure it reports the offset, line and column of the problem:
+//```
+// locjson::JSONTrusted root;
+// locjson::JSONParseError where;
+// if( !locjson::Validate(doc, root, where) )
+//   printf("%s at line %d column %d\n", where.message, (int)where.line, (int)where.column);
+// else
+//   int64_t id = locjson::LookupInt64(root, "id");
+//```
+// The `JSONTrusted` overloads don't take an error flag. They skip values by
+// tracking only strings and bracket depth, and never re-check syntax. Asking one
+// for the wrong type of value returns 0, false or an empty string.
+//
+//------------------------------------------------------------------------------
+// Benchmarks
+//------------------------------------------------------------------------------
+// `bench/locjson_bench.cpp` generates its own test documents and measures load,
+// lookup, iteration, string decoding, minify, NDJSON and builder throughput (MB/s, ns/op
+// and allocations per op). Build it with `-DBENCH_RAPIDJSON` or `-DBENCH_CPPREST`
+// to run the same workloads through a migration header instead. The locjson build
+// also measures streaming NDJSON export, in records per second.
+//
+//------------------------------------------------------------------------------
+// Instrumentation
+//------------------------------------------------------------------------------
+// Defining `LOCJSON_STATS` counts, per API function and per thread, the calls made,
+// the bytes examined by the character scanner, the values skipped and the
+// allocations. Without it the counting compiles away to nothing. The counters make
+// rescanning patterns such as `for(i<ArraySize) IndexArray(i)` easy to spot:
+//```
+// locjson::JSONStats before = locjson::ThreadStats();
+// locjson::JSONValue root = locjson::Parse(doc);
+// ... // read the document
+// locjson::JSONStats used = locjson::StatsDifference(locjson::ThreadStats(), before);
+// locjson::PrintStats(used, stdout);
+// double ratio = locjson::StatsAmplification(used); // bytes scanned per byte of document
+//```
+// `GlobalStats()` sums the counters of every thread, including threads that have
+// exited. Work done inside an instrumented function is counted against the
+// innermost one, and work done outside all of them against `JSONStatOther`.
+//
+//------------------------------------------------------------------------------
 
 #if !defined(LOCJSON_STRING)
 #include <string>
@@ -165,13 +500,75 @@
 #if !defined(LOCJSON_STRING_VIEW) && __cplusplus > 201402L
 #include <string_view>
 #endif
-#if !defined(LOCJSON_STRING_STREAM)
-#include <sstream>
-#endif
 
-#if !defined(LOCJSON_INT32) || !defined(LOCJSON_UINT32)
+#if !defined(LOCJSON_INT32) || !defined(LOCJSON_UINT32) || !defined(LOCJSON_INT64) || !defined(LOCJSON_UINT64)
 #include <cstdint>
 #endif
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include <type_traits>
+#if defined(LOCJSON_IMPLEMENTATION)
+#include <clocale>
+# if defined(LOCJSON_STATS)
+#  include <atomic>
+#  if !defined(LOCJSON_NO_THREADS)
+#   include <mutex>
+#  endif
+# endif
+#include <cmath>
+#include <chrono>
+# if !defined(LOCJSON_NO_THREADS)
+#  include <thread>
+# endif
+# if __cplusplus > 201402L && defined(__has_include)
+#  if __has_include(<charconv>)
+#   include <charconv>
+#  endif
+# endif
+#endif
+
+#if !defined(LOCJSON_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+# define LOCJSON_SSE2
+# if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#  define LOCJSON_AVX2
+# endif
+#endif
+#if defined(LOCJSON_IMPLEMENTATION) && !defined(LOCJSON_NO_MMAP)
+# if defined(_WIN32)
+#  if !defined(WIN32_LEAN_AND_MEAN)
+#   define WIN32_LEAN_AND_MEAN
+#  endif
+#  if !defined(NOMINMAX)
+#   define NOMINMAX
+#  endif
+#  include <windows.h>
+# else
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+# endif
+#endif
+#if defined(LOCJSON_IMPLEMENTATION) && !defined(LOCJSON_WIDE)
+# if defined(_WIN32)
+#  include <io.h>
+# else
+#  include <sys/uio.h>
+#  include <unistd.h>
+#  include <errno.h>
+# endif
+#endif
+#if defined(LOCJSON_IMPLEMENTATION) && defined(LOCJSON_SSE2)
+# include <emmintrin.h>
+# if defined(LOCJSON_AVX2)
+#  include <immintrin.h>
+# endif
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# endif
+#endif
 
 #if !defined(LOCJSON_EXCEPTION)
 #define LOCJSON_EXCEPTION(literal)
@@ -181,6 +578,24 @@
 #define LOCJSON_FUNCTION
 #endif
 
+#if !defined(LOCJSON_MAX_DEPTH)
+#define LOCJSON_MAX_DEPTH 512
+#endif
+
+#if defined(LOCJSON_STATS)
+# define LOCJSON_STAT_SCOPE(function)  locjson::_StatScope _statScope(locjson::function)
+# define LOCJSON_STAT_SCANNED(count)   locjson::_StatAdd(1, count)
+# define LOCJSON_STAT_SKIP()           locjson::_StatAdd(2, 1)
+# define LOCJSON_STAT_ALLOCATION()     locjson::_StatAdd(3, 1)
+# define LOCJSON_STAT_DOCUMENT(length) locjson::_StatDocument(length)
+#else
+# define LOCJSON_STAT_SCOPE(function)
+# define LOCJSON_STAT_SCANNED(count)
+# define LOCJSON_STAT_SKIP()
+# define LOCJSON_STAT_ALLOCATION()
+# define LOCJSON_STAT_DOCUMENT(length)
+#endif
+
 #if !defined(LOCJSON_LITERAL)
 # if defined(LOCJSON_WIDE)
 #  define LOCJSON_LITERAL(x) L ## x
@@ -189,6 +604,10 @@
 # endif
 #endif
 
+#if defined(LOCJSON_WIDE) && defined(LOCJSON_WIDE_UTF8)
+# error "LOCJSON_WIDE and LOCJSON_WIDE_UTF8 can't be used together"
+#endif
+
 #if !defined(LOCJSON_STRLEN)
 # if defined(LOCJSON_WIDE)
 #  define LOCJSON_STRLEN wcslen
@@ -197,14 +616,6 @@
 # endif
 #endif
 
-#if !defined(LOCJSON_STRTOL)
-# if defined(LOCJSON_WIDE)
-#  define LOCJSON_STRTOL std::wcstol
-# else
-#  define LOCJSON_STRTOL std::strtol
-# endif
-#endif
-
 namespace locjson
 {
 	#ifdef LOCJSON_CHAR
@@ -227,6 +638,18 @@ namespace locjson
 	typedef uint32_t UInt32;
 	#endif
 
+	#ifdef LOCJSON_INT64
+	typedef LOCJSON_INT64 Int64;
+	#else
+	typedef int64_t Int64;
+	#endif
+
+	#ifdef LOCJSON_UINT64
+	typedef LOCJSON_UINT64 UInt64;
+	#else
+	typedef uint64_t UInt64;
+	#endif
+
 	#ifdef LOCJSON_STRING
 	typedef LOCJSON_STRING String;
 	#elif defined(LOCJSON_WIDE)
@@ -244,39 +667,469 @@ namespace locjson
 	typedef std::string_view StringView;
 	# endif
 	#else
-	typedef String StringView;
-	#endif
+	// Minimal non-owning view for compilers without std::string_view, providing only what locjson uses.
+	class StringView
+	{
+	public:
+		static const size_t npos = ~(size_t)0;
+		StringView()                             : p(), n() {}
+		StringView(const Char* s)                : p(s), n(LOCJSON_STRLEN(s)) {}
+		StringView(const Char* s, size_t length) : p(s), n(length) {}
+		StringView(const String& s)              : p(s.data()), n(s.size()) {}
+		operator String() const { return n ? String(p, n) : String(); }
 
-	#ifdef LOCJSON_STRING_STREAM
-	typedef LOCJSON_STRING_STREAM StringStream;
-	#elif defined(LOCJSON_WIDE)
-	typedef std::wstringstream StringStream;
-	#else
-	typedef std::stringstream StringStream;
+		const Char* data() const   { return p; }
+		size_t      size() const   { return n; }
+		size_t      length() const { return n; }
+		bool        empty() const  { return n == 0; }
+		const Char* begin() const  { return p; }
+		const Char* end() const    { return p + n; }
+		const Char& back() const   { return p[n-1]; }
+		const Char& operator[](size_t i) const { return p[i]; }
+
+		StringView substr(size_t pos, size_t count = npos) const
+		{
+			if( pos > n ) { pos = n; }
+			return StringView(p + pos, count < n - pos ? count : n - pos);
+		}
+		int compare(const StringView& s) const
+		{
+			int c = std::char_traits<Char>::compare(p, s.p, n < s.n ? n : s.n);
+			return c ? c : n < s.n ? -1 : n > s.n ? 1 : 0;
+		}
+		int compare(size_t pos, size_t count, const StringView& s) const { return substr(pos, count).compare(s); }
+		size_t find(Char c, size_t pos = 0) const
+		{
+			for( ; pos < n; ++pos )
+				if( p[pos] == c ) { return pos; }
+			return npos;
+		}
+		size_t find_first_of(const StringView& set, size_t pos = 0) const
+		{
+			for( ; pos < n; ++pos )
+				if( set.find(p[pos]) != npos ) { return pos; }
+			return npos;
+		}
+		size_t find_first_not_of(const StringView& set, size_t pos = 0) const
+		{
+			for( ; pos < n; ++pos )
+				if( set.find(p[pos]) == npos ) { return pos; }
+			return npos;
+		}
+	private:
+		const Char* p;
+		size_t n;
+	};
+	inline bool operator==(const StringView& a, const StringView& b) { return a.size() == b.size() && a.compare(b) == 0; }
+	inline bool operator!=(const StringView& a, const StringView& b) { return !(a == b); }
+	inline bool operator< (const StringView& a, const StringView& b) { return a.compare(b) < 0; }
 	#endif
 
 	typedef StringView JSONValue;
 	typedef StringView JSONArray;
 	typedef String     JSONDocument;
+	#if defined(LOCJSON_WIDE_UTF8)
+	typedef std::wstring WideString;
+	#endif
+
+	// Receives the output of a streaming JSONBuilder: `count` spans (at most 3) to be written in order.
+	// Returning false stops the stream and sets the builder's error flag.
+	typedef bool (*JSONSink)(void* user, const StringView* parts, int count);
 
 	struct JSONBuilder
 	{
-		StringStream s;
-		bool empty = true;
-		operator StringStream&() { return s; }
+		JSONBuilder() : data(), size(), capacity(), fixed(), error(), depth(), first(1), ndjson(), sink(), sinkUser(), pending(), record() {}
+		JSONBuilder(Char* buffer, size_t capacity) : data(buffer), size(), capacity(capacity), fixed(true), error(), depth(), first(1), ndjson(), sink(), sinkUser(), pending(), record() {}
+		JSONBuilder(const JSONBuilder&) = delete;
+		JSONBuilder& operator=(const JSONBuilder&) = delete;
+		std::vector<Char> storage; // growable output, unless writing to a caller-supplied buffer
+		Char*  data;
+		size_t size, capacity;
+		bool   fixed;
+		bool   error; // a fixed buffer was too small (the output is truncated), or values were nested more than 63 deep
+		int    depth;
+		UInt64 first; // one bit per nesting level, set until a value has been written at that level
+		bool   ndjson; // top-level values are separated by newlines
+		// Streaming (see OpenOutputStream): `storage` is split into two halves of `capacity`, and `data` is the one being written.
+		JSONSink sink;
+		void*    sinkUser;
+		size_t   pending; // characters in the other half, waiting to be sent along with this one
+		size_t   record;  // where the top-level value being written began
+	};
+
+	struct JSONArrayIterator
+	{
+		JSONArrayIterator() : begin(JSONValue::npos), end(JSONValue::npos), out_error() {}
+		JSONArray array;
+		size_t begin, end; // span of the current element
+		bool* out_error;
+		JSONValue operator*() const;
+		JSONArrayIterator& operator++();
+		bool operator==(const JSONArrayIterator& o) const { return begin == o.begin; }
+		bool operator!=(const JSONArrayIterator& o) const { return begin != o.begin; }
+	};
+	struct JSONArrayRange
+	{
+		JSONArrayIterator first;
+		JSONArrayIterator begin() const { return first; }
+		JSONArrayIterator end() const   { return JSONArrayIterator(); }
+	};
+	struct JSONMember
+	{
+		StringView key; // raw key text, without quotes
+		JSONValue value;
+	};
+	struct JSONObjectIterator
+	{
+		JSONObjectIterator() : keyBegin(JSONValue::npos), keyEnd(JSONValue::npos), valueBegin(JSONValue::npos), valueEnd(JSONValue::npos), out_error() {}
+		JSONValue object;
+		size_t keyBegin, keyEnd, valueBegin, valueEnd; // spans of the current member
+		bool* out_error;
+		JSONMember operator*() const;
+		JSONObjectIterator& operator++();
+		bool operator==(const JSONObjectIterator& o) const { return keyBegin == o.keyBegin; }
+		bool operator!=(const JSONObjectIterator& o) const { return keyBegin != o.keyBegin; }
+	};
+	struct JSONObjectRange
+	{
+		JSONObjectIterator first;
+		JSONObjectIterator begin() const { return first; }
+		JSONObjectIterator end() const   { return JSONObjectIterator(); }
+	};
+
+	enum JSONFieldType { JSONFieldInt32, JSONFieldUInt32, JSONFieldInt64, JSONFieldUInt64, JSONFieldDouble, JSONFieldBool, JSONFieldString, JSONFieldValue, JSONFieldArray };
+	struct JSONField
+	{
+		const Char*   name;
+		size_t        length;
+		JSONFieldType type;
+		void*         out;
+		bool          found; // the key was present in the object
+		bool          error; // the key was present, but its value could not be converted to `type`
+	};
+	inline JSONField _Field(const Char* name, JSONFieldType type, void* out) { JSONField f = { name, LOCJSON_STRLEN(name), type, out, false, false }; return f; }
+	inline JSONField FieldInt32( const Char* name, Int32& out)     { return _Field(name, JSONFieldInt32,  &out); }
+	inline JSONField FieldUInt32(const Char* name, UInt32& out)    { return _Field(name, JSONFieldUInt32, &out); }
+	inline JSONField FieldInt64( const Char* name, Int64& out)     { return _Field(name, JSONFieldInt64,  &out); }
+	inline JSONField FieldUInt64(const Char* name, UInt64& out)    { return _Field(name, JSONFieldUInt64, &out); }
+	inline JSONField FieldDouble(const Char* name, double& out)    { return _Field(name, JSONFieldDouble, &out); }
+	inline JSONField FieldBool(  const Char* name, bool& out)      { return _Field(name, JSONFieldBool,   &out); }
+	inline JSONField FieldString(const Char* name, String& out)    { return _Field(name, JSONFieldString, &out); }
+	inline JSONField FieldValue( const Char* name, JSONValue& out) { return _Field(name, JSONFieldValue,  &out); }
+	inline JSONField FieldArray( const Char* name, JSONArray& out) { return _Field(name, JSONFieldArray,  &out); }
+
+	// Struct binding, see LOCJSON_BIND_BEGIN. Key hashes are computed at compile time.
+	struct JSONBoundField
+	{
+		const Char* name;
+		size_t      length;
+		UInt32      hash;
+		size_t    (*decode)(const JSONValue&, void* object, bool& out_error); // returns the end of the value
+	};
+	struct JSONBindTable
+	{
+		UInt32 multiplier, shift;
+		std::vector<unsigned char> slots; // field index + 1, or 0 for an empty slot
+		bool linear; // no perfect hash (colliding keys), so fields are compared in order
+	};
+	struct JSONBindReport
+	{
+		int found;   // bound fields present in the object
+		int missing; // bound fields absent from the object
+		int unknown; // keys in the object without a bound field
+		const Char* firstMissing;
+		StringView  firstUnknown;
+	};
+	template<class T> struct JSONBinding;
+	constexpr UInt32 _HashKey(const Char* s, size_t n, UInt32 h = 2166136261u) { return n ? _HashKey(s+1, n-1, (h ^ (UInt32)s[0]) * 16777619u) : h; }
+	constexpr bool _SameKey(const JSONBoundField& a, const JSONBoundField& b, size_t i = 0) { return i == a.length || (a.name[i] == b.name[i] && _SameKey(a, b, i+1)); }
+	constexpr bool _KeyBoundOnce(const JSONBoundField* f, size_t i, size_t j, size_t n) { return j == n || (!(f[i].hash == f[j].hash && f[i].length == f[j].length && _SameKey(f[i], f[j])) && _KeyBoundOnce(f, i, j+1, n)); }
+	constexpr bool _KeysUnique(const JSONBoundField* f, size_t n, size_t i = 0) { return i+1 >= n || (_KeyBoundOnce(f, i, i+1, n) && _KeysUnique(f, n, i+1)); }
+
+	// A read-only memory mapping of a whole file. Release it with CloseMappedFile once
+	// no JSONValues that point into it are in use.
+	struct JSONMappedFile
+	{
+		JSONMappedFile() : data(), size(), handle(), modified() {}
+		const char* data;
+		size_t      size;     // in bytes
+		void*       handle;   // platform mapping handle, if any
+		Int64       modified; // the file's last write time, in platform units
+	};
+
+	// One tape entry per value in an indexed document, stored in document order.
+	// Object members are stored as a key entry followed by its value entry.
+	struct JSONIndexEntry
+	{
+		UInt32 begin; // offset of the value's first character
+		UInt32 end;   // offset one past the value's last character
+		UInt32 count; // number of array elements / object members (numbers in an index cache: _CachedNumberBit | slot)
+		UInt32 next;  // tape position one past this value's subtree (i.e. the next sibling)
+	};
+	// A number decoded when an index cache was written, so that reading it doesn't re-parse the text.
+	struct JSONIndexNumber
+	{
+		UInt64 magnitude; // the absolute value, if `integer`
+		double value;
+		UInt32 integer;   // non-zero if the number is an integer that fits in 64 bits
+		UInt32 negative;
+	};
+	struct JSONIndex
+	{
+		JSONIndex() : cachedTape(), cachedNumbers(), cachedSize() {}
+		JSONValue text;
+		std::vector<JSONIndexEntry> tape;
+		// Set by LoadIndexCache: the tape and decoded numbers are read from the mapped cache file instead
+		JSONMappedFile         cache;
+		const JSONIndexEntry*  cachedTape;
+		const JSONIndexNumber* cachedNumbers;
+		UInt32                 cachedSize;
+	};
+	struct JSONNode
+	{
+		JSONNode() : index(), node() {}
+		JSONNode(const JSONIndex* index, UInt32 node) : index(index), node(node) {}
+		const JSONIndex* index;
+		UInt32 node;
+	};
+
+	// Splits newline-delimited JSON (one value per line) into records, reading a FILE in
+	// fixed-size chunks, or an in-memory span such as a JSONMappedFile.
+	struct JSONLineReader
+	{
+		JSONLineReader() : file(), text(), begin(), scan(), end(), inString(), escape(), eof(), records(), bytes(), startTime() {}
+		FILE*             file;      // 0 when reading from memory
+		const Char*       text;      // the span, or &buffer[0]
+		std::vector<Char> buffer;    // holds the current chunk (plus any record carried over from the previous one)
+		size_t            begin;     // start of the next record
+		size_t            scan;      // how far the record-boundary search has got
+		size_t            end;       // end of the text read so far
+		bool              inString, escape, eof;
+		UInt64            records, bytes, startTime;
+	};
+	struct JSONLineStats
+	{
+		UInt64 records, bytes;
+		double seconds, recordsPerSecond, bytesPerSecond;
+	};
+
+	// A JSON Pointer (RFC 6901), e.g. "/items/3/meta/id", compiled once for repeated queries.
+	// The token "*" matches every element of an array, or every member of an object.
+	struct JSONPathToken
+	{
+		String name;     // with "~1" and "~0" decoded
+		Int32  index;    // the token as an array index, or -1
+		bool   wildcard;
+	};
+	struct JSONPath
+	{
+		std::vector<JSONPathToken> tokens;
+	};
+	struct JSONPathMatch
+	{
+		int       path;  // which of the queried paths matched
+		JSONValue value;
+	};
+
+	// One change for ApplyEdits. Targets are JSON Pointers (without wildcards), and new values are
+	// JSON text that is copied verbatim, e.g. from BuilderOutput.
+	enum JSONEditType { JSONEditReplace, JSONEditRemove, JSONEditInsert };
+	struct JSONEdit
+	{
+		JSONEditType type;
+		const Char*  pointer; // Replace: the value. Remove: the object member or array element. Insert: the object or array to append to
+		const Char*  key;     // Insert into an object: the new member's key, unescaped
+		JSONValue    value;   // Replace/Insert: the new value
+	};
+	inline JSONEdit EditReplace(const Char* pointer, const JSONValue& value)                { JSONEdit e = { JSONEditReplace, pointer, 0, value }; return e; }
+	inline JSONEdit EditRemove(const Char* pointer)                                         { JSONEdit e = { JSONEditRemove, pointer, 0, JSONValue() }; return e; }
+	inline JSONEdit EditInsert(const Char* pointer, const Char* key, const JSONValue& value) { JSONEdit e = { JSONEditInsert, pointer, key, value }; return e; }
+	inline JSONEdit EditAppend(const Char* pointer, const JSONValue& value)                 { JSONEdit e = { JSONEditInsert, pointer, 0, value }; return e; }
+
+	// Instrumentation (see the Instrumentation section). Counters are attributed to the innermost
+	// instrumented function on the calling thread, or to JSONStatOther outside of them.
+	enum JSONStatFunction
+	{
+		JSONStatLookupValue,
+		JSONStatLookupFields,
+		JSONStatArraySize,
+		JSONStatIndexArray,
+		JSONStatIterateArray,
+		JSONStatIterateObject,
+		JSONStatAsString,
+		JSONStatParseIndex,
+		JSONStatValidate,
+		JSONStatQueryPaths,
+		JSONStatParseSax,
+		JSONStatSplit,
+		JSONStatNextRecord,
+		JSONStatNextValue,
+		JSONStatDecodeObject,
+		JSONStatApplyEdits,
+		JSONStatMinify,
+		JSONStatOther,
+		JSONStatFunctionCount
+	};
+	struct JSONCallStats
+	{
+		UInt64 calls;
+		UInt64 bytesScanned; // characters examined by the scanner
+		UInt64 skips;        // values passed over with SkipValue/SkipSubtree
+		UInt64 allocations;  // strings returned, and buffer/tape growth
+	};
+	struct JSONStats
+	{
+		JSONStats() : functions(), documents(), documentBytes() {}
+		JSONCallStats functions[JSONStatFunctionCount];
+		UInt64 documents;     // calls to Parse
+		UInt64 documentBytes; // total length of the documents passed to Parse
+	};
+#if defined(LOCJSON_STATS)
+	int  _StatEnter(int function);
+	void _StatLeave(int previous);
+	void _StatAdd(int counter, UInt64 count);
+	void _StatDocument(size_t length);
+	struct _StatScope
+	{
+		explicit _StatScope(JSONStatFunction function) : previous(_StatEnter(function)) {}
+		~_StatScope() { _StatLeave(previous); }
+		int previous;
+	};
+#endif
+
+	// The open containers of an iterative traversal, one bit per level (set for objects), so that
+	// nesting is bounded by LOCJSON_MAX_DEPTH instead of by the call stack.
+	struct _Nesting
+	{
+		UInt64 objects[(LOCJSON_MAX_DEPTH + 63) / 64];
+		int    depth;
+		_Nesting() : depth() {}
+		bool Push(bool object)
+		{
+			if( depth >= LOCJSON_MAX_DEPTH ) { return false; }
+			UInt64 bit = (UInt64)1 << (depth & 63);
+			objects[depth >> 6] = object ? objects[depth >> 6] | bit : objects[depth >> 6] & ~bit;
+			++depth;
+			return true;
+		}
+		bool InObject() const { return (objects[(depth-1) >> 6] >> ((depth-1) & 63)) & 1; }
+	};
+
+	// Event-driven parsing. A handler is any class with the callbacks below (deriving from
+	// JSONSaxHandler provides defaults that continue). Each callback returns JSONContinue,
+	// JSONStop to end the parse, or JSONSkip, which from StartObject/StartArray skips that
+	// subtree (without calling EndObject/EndArray) and from Key skips that member's value.
+	enum JSONSaxResult
+	{
+		JSONContinue,
+		JSONSkip,
+		JSONStop,
+	};
+	struct JSONSaxHandler
+	{
+		JSONSaxResult StartObject()                { return JSONContinue; }
+		JSONSaxResult Key(const StringView&)       { return JSONContinue; } // the raw characters between the quotes
+		JSONSaxResult EndObject()                  { return JSONContinue; }
+		JSONSaxResult StartArray()                 { return JSONContinue; }
+		JSONSaxResult EndArray()                   { return JSONContinue; }
+		JSONSaxResult String(const StringView&)    { return JSONContinue; } // the raw characters between the quotes, see UnescapeString
+		JSONSaxResult Number(const JSONValue&)     { return JSONContinue; } // the number's text, see AsInt32/AsDouble/etc
+		JSONSaxResult Bool(bool)                   { return JSONContinue; }
+		JSONSaxResult Null()                       { return JSONContinue; }
+	};
+
+	// Incremental parser for text that arrives in pieces (e.g. socket reads). All parsing state
+	// is kept between calls, so no character is examined twice, and only the unconsumed input
+	// (the value in progress) is buffered.
+	struct JSONPushParser
+	{
+		JSONPushParser() : begin(), scan(), valueBegin(), inValue(), inString(), escape(), scalar(), ended(), error() {}
+		std::vector<Char> buffer; // input that hasn't been returned by NextValue yet
+		std::vector<Char> stack;  // the unclosed '[' and '{' of the value in progress
+		size_t begin;             // start of the unconsumed input
+		size_t scan;              // how far parsing has got
+		size_t valueBegin;        // start of the value in progress
+		bool   inValue, inString, escape, scalar, ended, error;
+	};
+
+	// Where a document failed validation. `line` and `column` count from 1; `column` is in Chars.
+	struct JSONParseError
+	{
+		JSONParseError() : offset(), line(), column(), message() {}
+		size_t      offset;
+		size_t      line, column;
+		const char* message; // 0 if the document is valid
+	};
+	// A value within a document that has passed Validate. Its accessors don't re-check syntax
+	// and have no error output; asking for the wrong type of value returns 0/false/empty.
+	struct JSONTrusted
+	{
+		JSONTrusted() : value() {}
+		explicit JSONTrusted(const JSONValue& value) : value(value) {}
+		JSONValue value;
 	};
 
     JSONValue Parse(const JSONDocument&);
+	JSONValue Parse(const Char* text, size_t length);
+	// Newline-delimited JSON. Each record is a view of the reader's buffer (or span) that
+	// stays valid until the next call to NextRecord. Blank lines are skipped.
+	void      OpenLineReader(JSONLineReader&, const Char* text, size_t length);
+#if !defined(LOCJSON_WIDE)
+	void      OpenLineReader(JSONLineReader&, FILE* file, size_t chunkSize = 1<<20);
+#endif
+	bool      NextRecord(JSONLineReader&, JSONValue& out_record, bool& out_error);
+	JSONLineStats LineReaderStats(const JSONLineReader&);
+
+	// Push parsing. Input can be split at any character. NextValue returns each complete top-level
+	// value as a view that is valid until the next PushInput; a top-level number at the very end of
+	// the input is only known to be complete once EndInput has been called.
+	void      PushInput(JSONPushParser&, const Char* text, size_t length);
+	void      EndInput(JSONPushParser&);
+	bool      NextValue(JSONPushParser&, JSONValue& out_value, bool& out_error);
+	void      Reset(JSONPushParser&);
+
+	// Splits a large top-level array (or newline-delimited text) into its elements using several
+	// threads. `threads` of 0 uses every hardware thread. Elements are returned in document order.
+	bool      SplitArray(const JSONValue& array, std::vector<JSONValue>& out_elements, int threads, bool& out_error);
+	bool      SplitLines(const JSONValue& text, std::vector<JSONValue>& out_records, int threads, bool& out_error);
+	// Calls fn(size_t index, const JSONValue& value) for every value, with each thread handling a contiguous range.
+	template<class F>
+	void      ParallelForEach(const std::vector<JSONValue>& values, F fn, int threads);
+#if !defined(LOCJSON_NO_MMAP)
+	bool      OpenMappedFile(const char* path, JSONMappedFile& out_file, bool& out_error);
+	void      CloseMappedFile(JSONMappedFile&);
+# if !defined(LOCJSON_WIDE)
+	JSONValue Parse(const JSONMappedFile&);
+# endif
+#endif
 	Int32     LookupInt32(const JSONValue&, const Char* field, bool& out_error);
 	UInt32    LookupUInt32(const JSONValue&, const Char* field, bool& out_error);
+	Int64     LookupInt64(const JSONValue&, const Char* field, bool& out_error);
+	UInt64    LookupUInt64(const JSONValue&, const Char* field, bool& out_error);
+	double    LookupDouble(const JSONValue&, const Char* field, bool& out_error);
+	bool      LookupBool(const JSONValue&, const Char* field, bool& out_error);
 	String    LookupString(const JSONValue&, const Char* field, bool& out_error);
+	StringView LookupStringView(const JSONValue&, const Char* field, Char* buffer, size_t capacity, bool& out_error);
 	JSONValue LookupValue(const JSONValue&, const Char* field, bool& out_error);
 	JSONArray LookupArray(const JSONValue&, const Char* field, bool& out_error);
 	bool      HasField(const JSONValue&, const Char* field, bool& out_error);
 	bool      HasArrayField(const JSONValue&, const Char* field, bool& out_error);
+	bool      HasNullField(const JSONValue&, const Char* field, bool& out_error);
 	Int32     AsInt32(const JSONValue&, bool& out_error);
 	UInt32    AsUInt32(const JSONValue&, bool& out_error);
+	Int64     AsInt64(const JSONValue&, bool& out_error);
+	UInt64    AsUInt64(const JSONValue&, bool& out_error);
+	double    AsDouble(const JSONValue&, bool& out_error);
+	bool      AsBool(const JSONValue&, bool& out_error);
+	bool      IsNull(const JSONValue&, bool& out_error);
 	String    AsString(const JSONValue&, bool& out_error);
+	// Allocation-free string access. AsRawString returns the characters between the quotes with escape sequences
+	// left as-is. AsStringView returns the same span when there are no escapes, else decodes into `buffer`.
+	// UnescapeString decodes into `buffer` (UTF-8/16/32 depending on sizeof(Char)) and returns the decoded length,
+	// which may exceed `capacity`, in which case only `capacity` characters were written.
+	StringView AsRawString(const JSONValue&, bool& out_error);
+	StringView AsStringView(const JSONValue&, Char* buffer, size_t capacity, bool& out_error);
+	size_t    UnescapeString(const JSONValue&, Char* buffer, size_t capacity, bool& out_error);
 	JSONArray AsArray(const JSONValue&, bool& out_error);
 	bool      IsArray(const JSONValue&, bool& out_error);
 	bool      IsObject(const JSONValue&, bool& out_error);
@@ -284,37 +1137,785 @@ namespace locjson
 	int       ArraySize(const JSONArray&, bool& out_error);
 	JSONValue IndexArray(const JSONArray&, int index, bool& out_error);
 
+	// Indexed mode: builds the tape in a single pass, after which lookups don't rescan the text.
+	// `out_index` must outlive any JSONNode's returned from it, and the document must outlive the index.
+	JSONNode  Parse(const JSONValue&, JSONIndex& out_index, bool& out_error);
+	Int32     LookupInt32(const JSONNode&, const Char* field, bool& out_error);
+	UInt32    LookupUInt32(const JSONNode&, const Char* field, bool& out_error);
+	Int64     LookupInt64(const JSONNode&, const Char* field, bool& out_error);
+	UInt64    LookupUInt64(const JSONNode&, const Char* field, bool& out_error);
+	double    LookupDouble(const JSONNode&, const Char* field, bool& out_error);
+	bool      LookupBool(const JSONNode&, const Char* field, bool& out_error);
+	String    LookupString(const JSONNode&, const Char* field, bool& out_error);
+	StringView LookupStringView(const JSONNode&, const Char* field, Char* buffer, size_t capacity, bool& out_error);
+	JSONNode  LookupValue(const JSONNode&, const Char* field, bool& out_error);
+	JSONNode  LookupArray(const JSONNode&, const Char* field, bool& out_error);
+	bool      HasField(const JSONNode&, const Char* field, bool& out_error);
+	bool      HasArrayField(const JSONNode&, const Char* field, bool& out_error);
+	bool      HasNullField(const JSONNode&, const Char* field, bool& out_error);
+	Int32     AsInt32(const JSONNode&, bool& out_error);
+	UInt32    AsUInt32(const JSONNode&, bool& out_error);
+	Int64     AsInt64(const JSONNode&, bool& out_error);
+	UInt64    AsUInt64(const JSONNode&, bool& out_error);
+	double    AsDouble(const JSONNode&, bool& out_error);
+	bool      AsBool(const JSONNode&, bool& out_error);
+	bool      IsNull(const JSONNode&, bool& out_error);
+	String    AsString(const JSONNode&, bool& out_error);
+	StringView AsRawString(const JSONNode&, bool& out_error);
+	StringView AsStringView(const JSONNode&, Char* buffer, size_t capacity, bool& out_error);
+	JSONNode  AsArray(const JSONNode&, bool& out_error);
+	JSONValue AsValue(const JSONNode&, bool& out_error);
+	bool      IsArray(const JSONNode&, bool& out_error);
+	bool      IsObject(const JSONNode&, bool& out_error);
+
+	int       ArraySize(const JSONNode&, bool& out_error);
+	JSONNode  IndexArray(const JSONNode&, int index, bool& out_error);
+#if !defined(LOCJSON_NO_MMAP) && !defined(LOCJSON_WIDE)
+	// Index caches: SaveIndexCache writes an index of `source` (with its numbers decoded) to a binary file.
+	// LoadIndexCache maps that file, returning an invalid JSONNode (without an error) if it is missing or was
+	// written for a different version of `source`. The size and modification time are always compared, and
+	// `checkHash` also hashes the text. Release the mapping with CloseIndexCache before closing `source`.
+	bool      SaveIndexCache(const JSONIndex&, const JSONMappedFile& source, const char* path, bool& out_error);
+	JSONNode  LoadIndexCache(JSONIndex& out_index, const JSONMappedFile& source, const char* path, bool checkHash, bool& out_error);
+	void      CloseIndexCache(JSONIndex&);
+#endif
+#if defined(LOCJSON_WIDE_UTF8)
+	// Wide-character API over UTF-8 documents. The document stays UTF-8, so it is scanned a byte at a time
+	// and takes no more memory than the input. Wide keys are converted to UTF-8 once per lookup, and only the
+	// strings that are read out are transcoded, to UTF-16 or UTF-32 depending on the size of wchar_t.
+	// Invalid UTF-8 becomes U+FFFD.
+	void       TranscodeUTF8(const char* text, size_t length, WideString& out);
+	WideString AsWideString(const JSONValue&, bool& out_error);
+	WideString AsWideString(const JSONNode&, bool& out_error);
+	const char* _KeyToUTF8(const wchar_t* key, char* local, size_t capacity, std::vector<char>& heap);
+	struct _WideKey
+	{
+		explicit _WideKey(const wchar_t* key) : text(_KeyToUTF8(key, local, sizeof(local), heap)) {}
+		char local[256];
+		std::vector<char> heap; // for keys that don't fit in `local`
+		const char* text;
+	};
+	inline Int32      LookupInt32(const JSONValue& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return LookupInt32(v, key.text, out_error); }
+	inline UInt32     LookupUInt32(const JSONValue& v, const wchar_t* field, bool& out_error)     { _WideKey key(field); return LookupUInt32(v, key.text, out_error); }
+	inline Int64      LookupInt64(const JSONValue& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return LookupInt64(v, key.text, out_error); }
+	inline UInt64     LookupUInt64(const JSONValue& v, const wchar_t* field, bool& out_error)     { _WideKey key(field); return LookupUInt64(v, key.text, out_error); }
+	inline double     LookupDouble(const JSONValue& v, const wchar_t* field, bool& out_error)     { _WideKey key(field); return LookupDouble(v, key.text, out_error); }
+	inline bool       LookupBool(const JSONValue& v, const wchar_t* field, bool& out_error)       { _WideKey key(field); return LookupBool(v, key.text, out_error); }
+	inline WideString LookupString(const JSONValue& v, const wchar_t* field, bool& out_error)     { _WideKey key(field); return AsWideString(LookupValue(v, key.text, out_error), out_error); }
+	inline JSONValue  LookupValue(const JSONValue& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return LookupValue(v, key.text, out_error); }
+	inline JSONArray  LookupArray(const JSONValue& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return LookupArray(v, key.text, out_error); }
+	inline bool       HasField(const JSONValue& v, const wchar_t* field, bool& out_error)         { _WideKey key(field); return HasField(v, key.text, out_error); }
+	inline bool       HasArrayField(const JSONValue& v, const wchar_t* field, bool& out_error)    { _WideKey key(field); return HasArrayField(v, key.text, out_error); }
+	inline bool       HasNullField(const JSONValue& v, const wchar_t* field, bool& out_error)     { _WideKey key(field); return HasNullField(v, key.text, out_error); }
+	inline Int32      LookupInt32(const JSONNode& v, const wchar_t* field, bool& out_error)       { _WideKey key(field); return LookupInt32(v, key.text, out_error); }
+	inline UInt32     LookupUInt32(const JSONNode& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return LookupUInt32(v, key.text, out_error); }
+	inline Int64      LookupInt64(const JSONNode& v, const wchar_t* field, bool& out_error)       { _WideKey key(field); return LookupInt64(v, key.text, out_error); }
+	inline UInt64     LookupUInt64(const JSONNode& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return LookupUInt64(v, key.text, out_error); }
+	inline double     LookupDouble(const JSONNode& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return LookupDouble(v, key.text, out_error); }
+	inline bool       LookupBool(const JSONNode& v, const wchar_t* field, bool& out_error)        { _WideKey key(field); return LookupBool(v, key.text, out_error); }
+	inline WideString LookupString(const JSONNode& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return AsWideString(LookupValue(v, key.text, out_error), out_error); }
+	inline JSONNode   LookupValue(const JSONNode& v, const wchar_t* field, bool& out_error)       { _WideKey key(field); return LookupValue(v, key.text, out_error); }
+	inline JSONNode   LookupArray(const JSONNode& v, const wchar_t* field, bool& out_error)       { _WideKey key(field); return LookupArray(v, key.text, out_error); }
+	inline bool       HasField(const JSONNode& v, const wchar_t* field, bool& out_error)          { _WideKey key(field); return HasField(v, key.text, out_error); }
+	inline bool       HasArrayField(const JSONNode& v, const wchar_t* field, bool& out_error)     { _WideKey key(field); return HasArrayField(v, key.text, out_error); }
+	inline bool       HasNullField(const JSONNode& v, const wchar_t* field, bool& out_error)      { _WideKey key(field); return HasNullField(v, key.text, out_error); }
+#endif
+
+	// Strict validation (RFC 8259) of a whole document: bad escapes, control characters and invalid
+	// UTF-8 in strings, malformed numbers, mismatched brackets, trailing commas and trailing text.
+	// On success `out_root` is the trusted root value; on failure `out_error` says where and why.
+	bool        Validate(const JSONValue&, JSONTrusted& out_root, JSONParseError& out_error);
+	JSONTrusted LookupValue(const JSONTrusted&, const Char* field);
+	Int32       LookupInt32(const JSONTrusted&, const Char* field);
+	UInt32      LookupUInt32(const JSONTrusted&, const Char* field);
+	Int64       LookupInt64(const JSONTrusted&, const Char* field);
+	UInt64      LookupUInt64(const JSONTrusted&, const Char* field);
+	double      LookupDouble(const JSONTrusted&, const Char* field);
+	bool        LookupBool(const JSONTrusted&, const Char* field);
+	String      LookupString(const JSONTrusted&, const Char* field);
+	bool        HasField(const JSONTrusted&, const Char* field);
+	Int32       AsInt32(const JSONTrusted&);
+	UInt32      AsUInt32(const JSONTrusted&);
+	Int64       AsInt64(const JSONTrusted&);
+	UInt64      AsUInt64(const JSONTrusted&);
+	double      AsDouble(const JSONTrusted&);
+	bool        AsBool(const JSONTrusted&);
+	bool        IsNull(const JSONTrusted&);
+	String      AsString(const JSONTrusted&);
+	bool        IsArray(const JSONTrusted&);
+	bool        IsObject(const JSONTrusted&);
+	int         ArraySize(const JSONTrusted&);
+	JSONTrusted IndexArray(const JSONTrusted&, int index);
+
+	// Fills every field in a single walk over the object's members, stopping once all have been found.
+	// Returns the number of fields found. Missing fields only clear `found`; they don't set `out_error`.
+	int       LookupFields(const JSONValue&, JSONField* fields, int count, bool& out_error);
+	template<int N>
+	int       LookupFields(const JSONValue& v, JSONField (&fields)[N], bool& out_error) { return LookupFields(v, fields, N, out_error); }
+
+	// Decodes an object into a struct that was bound with LOCJSON_BIND_BEGIN/LOCJSON_BIND_FIELD/LOCJSON_BIND_END,
+	// making a single pass over the object. Returns true if every bound field was present.
+	template<class T>
+	bool      DecodeObject(const JSONValue&, T& out, bool& out_error, JSONBindReport* out_report = 0);
+
+	// Instrumentation. All zero unless LOCJSON_STATS is defined. ThreadStats reads the calling thread's
+	// counters, GlobalStats sums every thread's (including threads that have exited).
+	JSONStats ThreadStats();
+	JSONStats GlobalStats();
+	void      ResetThreadStats();
+	JSONStats StatsDifference(const JSONStats& after, const JSONStats& before);
+	double    StatsAmplification(const JSONStats&); // bytes scanned per byte of document parsed
+	const char* StatsFunctionName(JSONStatFunction);
+	void      PrintStats(const JSONStats&, FILE* out);
+
+	// Path queries. QueryPath returns the first match (or an empty value). QueryPaths answers several
+	// paths in one forward scan, skipping subtrees that no path leads into, and returns the number of
+	// matches, which are appended to `out_matches` in document order.
+	bool      CompilePath(const Char* pointer, JSONPath& out_path, bool& out_error);
+	JSONValue QueryPath(const JSONValue&, const JSONPath&, bool& out_error);
+	int       QueryPaths(const JSONValue&, const JSONPath* paths, int count, std::vector<JSONPathMatch>& out_matches, bool& out_error);
+
+	// Patching. Finds every edit's target in one scan, then writes the patched document to `out`,
+	// copying the text between the edits as-is, so unchanged values are never re-serialized.
+	// Removing a member also removes its comma. Edits may not overlap; on error `out` is left empty.
+	bool      ApplyEdits(const JSONValue&, const JSONEdit* edits, int count, JSONDocument& out, bool& out_error);
+	template<int N>
+	bool      ApplyEdits(const JSONValue& v, const JSONEdit (&edits)[N], JSONDocument& out, bool& out_error) { return ApplyEdits(v, edits, N, out, out_error); }
+
+	// Removes the whitespace outside of strings, writing to `out` (which may be `text.data()`, to minify in place)
+	// and returning the new length. Nothing else is checked, except that the last string is terminated.
+	size_t    Minify(const JSONValue& text, Char* out, bool& out_error);
+	void      Minify(JSONDocument&, bool& out_error);
+
+	// Walks the value in a single pass, calling the handler for each token. Returns false if
+	// the handler stopped the parse, or an error was found.
+	template<class Handler>
+	bool      ParseSax(const JSONValue&, Handler& handler, bool& out_error);
+
+	// Forward iteration over array elements / object members, e.g. `for(JSONValue e : IterateArray(a, error))`
+	// Each step resumes from the end of the previous value, so a full iteration is a single pass.
+	JSONArrayRange  IterateArray(const JSONArray&, bool& out_error);
+	JSONObjectRange IterateObject(const JSONValue&, bool& out_error);
+
+	// Writing. Values inside objects take a key, values inside arrays (or at the top level) don't.
+	// Reset keeps the builder's capacity, so a long-lived builder stops allocating once it has warmed up.
+	void      Reset(JSONBuilder&);
+	JSONValue BuilderOutput(const JSONBuilder&);
+	// Streaming output, for writing more than fits in memory. The builder keeps a fixed buffer of `bufferSize`
+	// characters in two halves; when both are full they are sent to the sink in one call (one writev for a file
+	// descriptor). Strings longer than half the buffer are passed to the sink without being copied. In NDJSON
+	// mode each top-level value is a line, and a line is only split between calls if it is longer than half the
+	// buffer. CloseOutputStream sends what is left and returns false if any write failed.
+	void      OpenOutputStream(JSONBuilder&, JSONSink sink, void* user, bool ndjson = false, size_t bufferSize = 1<<16);
+#if !defined(LOCJSON_WIDE)
+	void      OpenOutputStream(JSONBuilder&, int fd, bool ndjson = false, size_t bufferSize = 1<<16);
+#endif
+	bool      FlushOutputStream(JSONBuilder&);
+	bool      CloseOutputStream(JSONBuilder&);
 	void BeginObject(JSONBuilder&);
+	void BeginObject(JSONBuilder&, const Char* key);
+	void EndObject(JSONBuilder&);
+	void BeginArray(JSONBuilder&);
+	void BeginArray(JSONBuilder&, const Char* key);
+	void EndArray(JSONBuilder&);
 	void AddString(JSONBuilder&, const Char* key, const Char* value);
+	void AddInt32(JSONBuilder&, const Char* key, Int32 value);
+	void AddUInt32(JSONBuilder&, const Char* key, UInt32 value);
+	void AddInt64(JSONBuilder&, const Char* key, Int64 value);
+	void AddUInt64(JSONBuilder&, const Char* key, UInt64 value);
+	void AddDouble(JSONBuilder&, const Char* key, double value);
+	void AddBool(JSONBuilder&, const Char* key, bool value);
+	void AddNull(JSONBuilder&, const Char* key);
 	template<class... Args>
 	void AddArray(JSONBuilder&, const Char* key, Args... args);
-	void EndObject(JSONBuilder&);
+	void AddValue(JSONBuilder&, const Char* value);
+	void AddValue(JSONBuilder&, Int32 value);
+	void AddValue(JSONBuilder&, UInt32 value);
+	void AddValue(JSONBuilder&, Int64 value);
+	void AddValue(JSONBuilder&, UInt64 value);
+	void AddValue(JSONBuilder&, double value);
+	void AddValue(JSONBuilder&, bool value);
+	void AddNull(JSONBuilder&);
 }
 
 namespace locjson
 {
 #if defined(LOCJSON_IMPLEMENTATION)
-    JSONValue Parse(const JSONDocument& doc) { return doc; }
+    JSONValue Parse(const JSONDocument& doc) { LOCJSON_STAT_DOCUMENT(doc.size()); return doc; }
+	LOCJSON_FUNCTION JSONValue Parse(const Char* text, size_t length) { LOCJSON_STAT_DOCUMENT(length); return length ? JSONValue(text, length) : JSONValue(); }
 
-	inline size_t SkipNumber(const JSONValue& v, size_t i, bool& out_error)
+#if !defined(LOCJSON_NO_MMAP)
+	LOCJSON_FUNCTION bool OpenMappedFile(const char* path, JSONMappedFile& out_file, bool& out_error)
 	{
-		size_t j = v.find_first_not_of(LOCJSON_LITERAL("+-0123456789.eE"), i);
-		if( i==j ) { LOCJSON_EXCEPTION("Invalid Number"); out_error = true; return i+1; }
-		return j;
+		out_file = JSONMappedFile();
+# if defined(_WIN32)
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if( file == INVALID_HANDLE_VALUE ) { LOCJSON_EXCEPTION("Could not open file"); out_error = true; return false; }
+		LARGE_INTEGER size;
+		FILETIME written;
+		if( !GetFileSizeEx(file, &size) || !GetFileTime(file, 0, 0, &written) ) { CloseHandle(file); LOCJSON_EXCEPTION("Could not read file size"); out_error = true; return false; }
+		out_file.modified = (Int64)(((UInt64)written.dwHighDateTime << 32) | written.dwLowDateTime);
+		if( size.QuadPart == 0 ) { CloseHandle(file); out_file.data = ""; return true; }
+		HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+		CloseHandle(file);//the mapping keeps the file open
+		if( !mapping ) { LOCJSON_EXCEPTION("Could not map file"); out_error = true; return false; }
+		const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if( !view ) { CloseHandle(mapping); LOCJSON_EXCEPTION("Could not map file"); out_error = true; return false; }
+		out_file.data = (const char*)view;
+		out_file.size = (size_t)size.QuadPart;
+		out_file.handle = mapping;
+# else
+		int file = open(path, O_RDONLY);
+		if( file < 0 ) { LOCJSON_EXCEPTION("Could not open file"); out_error = true; return false; }
+		struct stat info;
+		if( fstat(file, &info) != 0 ) { close(file); LOCJSON_EXCEPTION("Could not read file size"); out_error = true; return false; }
+		out_file.modified = (Int64)info.st_mtime * 1000000000;
+#  if defined(__APPLE__)
+		out_file.modified += info.st_mtimespec.tv_nsec;
+#  elif defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+		out_file.modified += info.st_mtim.tv_nsec;
+#  endif
+		if( info.st_size == 0 ) { close(file); out_file.data = ""; return true; }
+		void* view = mmap(0, (size_t)info.st_size, PROT_READ, MAP_SHARED, file, 0);
+		close(file);//the mapping keeps the file open
+		if( view == MAP_FAILED ) { LOCJSON_EXCEPTION("Could not map file"); out_error = true; return false; }
+		out_file.data = (const char*)view;
+		out_file.size = (size_t)info.st_size;
+# endif
+		return true;
 	}
-	inline size_t SkipString(const JSONValue& v, size_t i, bool& out_error)
+	LOCJSON_FUNCTION void CloseMappedFile(JSONMappedFile& file)
 	{
-		if( v[i] != '"' ) { LOCJSON_EXCEPTION("Invalid String"); out_error = true; return i+1; }
-		for(++i; i<v.size();)
+		if( file.size )
 		{
-			i =  v.find_first_of(LOCJSON_LITERAL("\"\\"), i);
-			if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated String"); out_error = true; return i; }
-			if( v[i] == '"' ) { break; }
-			if( i+1 < v.size() )
+# if defined(_WIN32)
+			UnmapViewOfFile(file.data);
+			CloseHandle((HANDLE)file.handle);
+# else
+			munmap((void*)file.data, file.size);
+# endif
+		}
+		file = JSONMappedFile();
+	}
+# if !defined(LOCJSON_WIDE)
+	LOCJSON_FUNCTION JSONValue Parse(const JSONMappedFile& file) { return Parse(file.data, file.size); }
+# endif
+#endif
+
+	// Character-class scanning used by the Skip* functions. `_FindFirstOf<'"','\\'>(v, i)` behaves
+	// like `v.find_first_of("\"\\", i)`, but classifies 16 (SSE2) or 32 (AVX2) characters at a time.
+	template<class C> inline bool _In(C) { return false; }
+	template<class C, class... Cs> inline bool _In(C c, char c0, Cs... cs) { return c == (C)c0 || _In(c, cs...); }
+	template<char... Set> inline size_t _ScanScalar(const Char* p, size_t i, size_t n, bool negate)
+	{
+		for(; i<n; ++i)
+			if( _In(p[i], Set...) != negate ) { return i; }
+		return JSONValue::npos;
+	}
+#if defined(LOCJSON_SSE2)
+	inline unsigned _TrailingZeros(unsigned x)
+	{
+	#if defined(_MSC_VER)
+		unsigned long r; _BitScanForward(&r, x); return (unsigned)r;
+	#else
+		return (unsigned)__builtin_ctz(x);
+	#endif
+	}
+	template<class V> inline V _MatchSSE2(V) { return _mm_setzero_si128(); }
+	template<class V, class... Cs> inline V _MatchSSE2(V x, char c0, Cs... cs) { return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(c0)), _MatchSSE2(x, cs...)); }
+	template<char... Set> inline size_t _ScanSSE2(const char* p, size_t i, size_t n, bool negate)
+	{
+		unsigned flip = negate ? 0xFFFFu : 0u;
+		for(; i+16 <= n; i += 16)
+		{
+			unsigned mask = flip ^ (unsigned)_mm_movemask_epi8(_MatchSSE2(_mm_loadu_si128((const __m128i*)(p+i)), Set...));
+			if( mask ) { return i + _TrailingZeros(mask); }
+		}
+		return _ScanScalar<Set...>((const Char*)p, i, n, negate);
+	}
+# if defined(LOCJSON_AVX2)
+#  if defined(__GNUC__) || defined(__clang__)
+#   define LOCJSON_TARGET_AVX2 __attribute__((target("avx2")))
+#  else
+#   define LOCJSON_TARGET_AVX2
+#  endif
+	template<class V> LOCJSON_TARGET_AVX2 inline V _MatchAVX2(V) { return _mm256_setzero_si256(); }
+	template<class V, class... Cs> LOCJSON_TARGET_AVX2 inline V _MatchAVX2(V x, char c0, Cs... cs) { return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(c0)), _MatchAVX2(x, cs...)); }
+	template<char... Set> LOCJSON_TARGET_AVX2 inline size_t _ScanAVX2(const char* p, size_t i, size_t n, bool negate)
+	{
+		unsigned flip = negate ? 0xFFFFFFFFu : 0u;
+		for(; i+32 <= n; i += 32)
+		{
+			unsigned mask = flip ^ (unsigned)_mm256_movemask_epi8(_MatchAVX2(_mm256_loadu_si256((const __m256i*)(p+i)), Set...));
+			if( mask ) { return i + _TrailingZeros(mask); }
+		}
+		return _ScanSSE2<Set...>(p, i, n, negate);
+	}
+	inline bool _HasAVX2()
+	{
+	#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if( info[0] < 7 ) { return false; }
+		__cpuid(info, 1);
+		if( !(info[2] & (1<<27)) || (_xgetbv(0) & 6) != 6 ) { return false; }//OSXSAVE, and the OS saves YMM state
+		__cpuidex(info, 7, 0);
+		return 0 != (info[1] & (1<<5));
+	#else
+		__builtin_cpu_init();
+		return 0 != __builtin_cpu_supports("avx2");
+	#endif
+	}
+# endif
+#endif
+	template<char... Set> inline size_t _ScanRange(const Char* p, size_t i, size_t n, bool negate)
+	{
+		if( i >= n ) { return JSONValue::npos; }
+		if( _In(p[i], Set...) != negate ) { LOCJSON_STAT_SCANNED(1); return i; }//most scans stop immediately
+		if( i+1 < n && _In(p[i+1], Set...) != negate ) { LOCJSON_STAT_SCANNED(2); return i+1; }//or after one separator, in minified text
+		size_t end;
+#if defined(LOCJSON_SSE2)
+		if( sizeof(Char) == 1 )
+		{
+	# if defined(LOCJSON_AVX2)
+			static const bool avx2 = _HasAVX2();
+			if( avx2 && n-i >= 32 ) { end = _ScanAVX2<Set...>((const char*)p, i+1, n, negate); }
+			else
+	# endif
+			end = _ScanSSE2<Set...>((const char*)p, i+1, n, negate);
+		}
+		else
+#endif
+		end = _ScanScalar<Set...>(p, i+1, n, negate);
+		LOCJSON_STAT_SCANNED((end == JSONValue::npos ? n : end+1) - i);
+		return end;
+	}
+	template<char... Set> inline size_t _Scan(const JSONValue& v, size_t i, bool negate) { return _ScanRange<Set...>(v.data(), i, v.size(), negate); }
+	template<char... Set> inline size_t _FindFirstOf(const JSONValue& v, size_t i)    { return _Scan<Set...>(v, i, false); }
+	template<char... Set> inline size_t _FindFirstNotOf(const JSONValue& v, size_t i) { return _Scan<Set...>(v, i, true); }
+#if defined(LOCJSON_COMPACT_INPUT)
+	//there's no whitespace to look for, only a single comma or colon
+	inline size_t _SkipSeparators(const JSONValue& v, size_t i)    { i += i < v.size() && v[i] == ','; return i < v.size() ? i : JSONValue::npos; }
+	inline size_t _SkipKeySeparators(const JSONValue& v, size_t i) { i += i < v.size() && v[i] == ':'; return i < v.size() ? i : JSONValue::npos; }
+#else
+	inline size_t _SkipSeparators(const JSONValue& v, size_t i) { return _FindFirstNotOf<',',' ','\t','\r','\n','\f','\b'>(v, i); }
+	inline size_t _SkipKeySeparators(const JSONValue& v, size_t i) { return _FindFirstNotOf<':',' ','\t','\r','\n','\f','\b'>(v, i); }
+#endif
+
+	inline UInt64 _Nanoseconds()
+	{
+		return (UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	inline void _ResetLineReader(JSONLineReader& r)
+	{
+		r.begin = r.scan = r.end = 0;
+		r.inString = r.escape = r.eof = false;
+		r.records = r.bytes = 0;
+		r.startTime = _Nanoseconds();
+	}
+	LOCJSON_FUNCTION void OpenLineReader(JSONLineReader& r, const Char* text, size_t length)
+	{
+		_ResetLineReader(r);
+		r.file = 0;
+		r.text = text;
+		r.end = length;
+		r.eof = true;
+	}
+#if !defined(LOCJSON_WIDE)
+	LOCJSON_FUNCTION void OpenLineReader(JSONLineReader& r, FILE* file, size_t chunkSize)
+	{
+		_ResetLineReader(r);
+		r.file = file;
+		r.buffer.resize(chunkSize ? chunkSize : 1);
+		r.text = &r.buffer[0];
+	}
+#endif
+	// Advances r.scan to the next newline that isn't inside a string, returning false if the
+	// text read so far runs out first. The string state is kept, so no character is scanned twice.
+	inline bool _FindRecordEnd(JSONLineReader& r)
+	{
+		const Char* p = r.text;
+		size_t i = r.scan, n = r.end;
+		while( i < n )
+		{
+			if( r.escape )
+			{
+				r.escape = false;
+				++i;
+			}
+			else if( r.inString )
+			{
+				i = _ScanRange<'"','\\'>(p, i, n, false);
+				if( i == JSONValue::npos ) { break; }
+				if( p[i] == '\\' ) { r.escape = true; }
+				else                { r.inString = false; }
+				++i;
+			}
+			else
+			{
+				i = _ScanRange<'"','\n'>(p, i, n, false);
+				if( i == JSONValue::npos ) { break; }
+				if( p[i] == '\n' ) { r.scan = i; return true; }
+				r.inString = true;
+				++i;
+			}
+		}
+		r.scan = n;
+		return false;
+	}
+	LOCJSON_FUNCTION bool NextRecord(JSONLineReader& r, JSONValue& out_record, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatNextRecord);
+		for(;;)
+		{
+			bool found = _FindRecordEnd(r);
+			if( !found && !r.eof )
+			{
+				//carry the partial record to the front of the buffer, then read the next chunk after it
+				if( r.begin )
+				{
+					memmove(&r.buffer[0], &r.buffer[r.begin], (r.end - r.begin)*sizeof(Char));
+					r.scan -= r.begin;
+					r.end  -= r.begin;
+					r.begin = 0;
+				}
+				if( r.end == r.buffer.size() )
+				{
+					r.buffer.resize(r.buffer.size()*2);//a single record is larger than the buffer
+					LOCJSON_STAT_ALLOCATION();
+				}
+				r.text = &r.buffer[0];
+				size_t count = fread(&r.buffer[r.end], sizeof(Char), r.buffer.size() - r.end, r.file);
+				if( count == 0 )
+				{
+					if( ferror(r.file) ) { LOCJSON_EXCEPTION("Error reading file"); out_error = true; return false; }
+					r.eof = true;
+				}
+				r.end += count;
+				continue;
+			}
+			if( !found && r.begin == r.end ) { return false; }
+			size_t first = r.begin, last = found ? r.scan : r.end;
+			size_t next = found ? last + 1 : last;
+			r.bytes += next - r.begin;
+			r.begin = r.scan = next;
+			while( first < last && _In(r.text[first],  ' ', '\t', '\r') ) { ++first; }
+			while( first < last && _In(r.text[last-1], ' ', '\t', '\r') ) { --last; }
+			if( first == last ) { continue; }
+			++r.records;
+			out_record = JSONValue(r.text + first, last - first);
+			return true;
+		}
+	}
+	LOCJSON_FUNCTION JSONLineStats LineReaderStats(const JSONLineReader& r)
+	{
+		JSONLineStats stats;
+		stats.records = r.records;
+		stats.bytes = r.bytes;
+		stats.seconds = (double)(_Nanoseconds() - r.startTime) * 1e-9;
+		stats.recordsPerSecond = stats.seconds > 0 ? (double)r.records / stats.seconds : 0;
+		stats.bytesPerSecond   = stats.seconds > 0 ? (double)r.bytes / stats.seconds : 0;
+		return stats;
+	}
+
+	LOCJSON_FUNCTION void Reset(JSONPushParser& p)
+	{
+		p.buffer.clear();
+		p.stack.clear();
+		p.begin = p.scan = p.valueBegin = 0;
+		p.inValue = p.inString = p.escape = p.scalar = p.ended = p.error = false;
+	}
+	LOCJSON_FUNCTION void PushInput(JSONPushParser& p, const Char* text, size_t length)
+	{
+		if( p.begin )
+		{
+			p.buffer.erase(p.buffer.begin(), p.buffer.begin() + p.begin);
+			p.scan -= p.begin;
+			p.valueBegin -= p.inValue ? p.begin : p.valueBegin;
+			p.begin = 0;
+		}
+		p.buffer.insert(p.buffer.end(), text, text + length);
+	}
+	LOCJSON_FUNCTION void EndInput(JSONPushParser& p) { p.ended = true; }
+	LOCJSON_FUNCTION bool NextValue(JSONPushParser& p, JSONValue& out_value, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatNextValue);
+		if( p.error ) { out_error = true; return false; }
+		const Char* text = p.buffer.empty() ? 0 : &p.buffer[0];
+		size_t i = p.scan, n = p.buffer.size();
+		size_t end = JSONValue::npos;
+		while( end == JSONValue::npos )
+		{
+			if( i >= n )
+			{
+				if( p.ended && p.scalar ) { end = n; break; }//a number or literal can only be terminated by the end of input
+				if( p.ended && p.inValue ) { LOCJSON_EXCEPTION("Unterminated value"); p.error = out_error = true; }
+				p.scan = n;
+				return false;
+			}
+			if( p.escape )
+			{
+				p.escape = false;
+				++i;
+			}
+			else if( p.inString )
+			{
+				i = _ScanRange<'"','\\'>(text, i, n, false);
+				if( i == JSONValue::npos ) { i = n; continue; }
+				if( text[i] == '\\' ) { p.escape = true; }
+				else                  { p.inString = false; if( p.stack.empty() ) { end = i+1; } }
+				++i;
+			}
+			else if( p.scalar )
+			{
+				i = _ScanRange<' ','\t','\r','\n','\f','\b',',','"','[',']','{','}'>(text, i, n, false);
+				if( i == JSONValue::npos ) { i = n; continue; }
+				end = i;
+			}
+			else if( p.inValue )
+			{
+				i = _ScanRange<'"','[',']','{','}'>(text, i, n, false);
+				if( i == JSONValue::npos ) { i = n; continue; }
+				Char c = text[i];
+				if( c == '"' ) { p.inString = true; }
+				else if( c == '[' || c == '{' ) { p.stack.push_back(c); }
+				else
+				{
+					if( p.stack.back() != (c == ']' ? '[' : '{') ) { LOCJSON_EXCEPTION("Mismatched brackets"); p.error = out_error = true; return false; }
+					p.stack.pop_back();
+					if( p.stack.empty() ) { end = i+1; }
+				}
+				++i;
+			}
+			else
+			{
+				i = _ScanRange<' ','\t','\r','\n','\f','\b'>(text, i, n, true);
+				if( i == JSONValue::npos ) { i = n; p.begin = n; continue; }
+				Char c = text[i];
+				if( c == ']' || c == '}' || c == ',' || c == ':' ) { LOCJSON_EXCEPTION("Unexpected character"); p.error = out_error = true; return false; }
+				p.inValue = true;
+				p.valueBegin = i;
+				if( c == '[' || c == '{' ) { p.stack.push_back(c); }
+				else if( c == '"' )        { p.inString = true; }
+				else                       { p.scalar = true; }
+				++i;
+			}
+		}
+		out_value = JSONValue(text + p.valueBegin, end - p.valueBegin);
+		p.inValue = p.scalar = false;
+		p.begin = p.scan = end;
+		return true;
+	}
+
+	inline int _ThreadCount(int threads)
+	{
+#if defined(LOCJSON_NO_THREADS)
+		(void)threads;
+		return 1;
+#else
+		if( threads <= 0 ) { threads = (int)std::thread::hardware_concurrency(); }
+		return threads > 0 ? threads : 1;
+#endif
+	}
+	// Splits [0, count) into one contiguous range per thread, and runs fn on each range.
+	LOCJSON_FUNCTION void _ParallelFor(size_t count, int threads, void (*fn)(void* context, size_t begin, size_t end), void* context)
+	{
+		size_t workers = (size_t)_ThreadCount(threads);
+		if( workers > count ) { workers = count; }
+#if !defined(LOCJSON_NO_THREADS)
+		if( workers > 1 )
+		{
+			std::vector<std::thread> pool;
+			pool.reserve(workers-1);
+			for(size_t t=1; t<workers; ++t)
+				pool.push_back(std::thread(fn, context, count*t/workers, count*(t+1)/workers));
+			fn(context, 0, count/workers);
+			for(size_t t=0; t<pool.size(); ++t)
+				pool[t].join();
+			return;
+		}
+#endif
+		if( count ) { fn(context, 0, count); }
+	}
+
+	// Parallel splitting makes three passes over equal-sized chunks of the text:
+	//  1) count the unescaped quotes in each chunk. Whether a chunk's first character is escaped is
+	//     found by counting the backslashes before it, so this doesn't depend on the other chunks.
+	//     A prefix sum of the quote counts then gives whether each chunk starts inside a string.
+	//  2) (arrays only) find each chunk's change in bracket depth, and prefix sum the depths.
+	//  3) with the string state and depth known at each chunk start, record the element boundaries.
+	struct _SplitChunk
+	{
+		size_t begin, end, quotes;
+		bool   inString;
+		int    depth, depthDelta;
+		std::vector<size_t> boundaries;
+	};
+	struct _SplitContext
+	{
+		const Char* text;
+		std::vector<_SplitChunk>* chunks;
+		bool lines, emit;
+	};
+	inline bool _EscapedAt(const Char* p, size_t i)
+	{
+		size_t k = i;
+		while( k > 0 && p[k-1] == '\\' ) { --k; }
+		return 0 != ((i - k) & 1);
+	}
+	inline void _CountQuotes(void* context, size_t first, size_t last)
+	{
+		const _SplitContext& ctx = *(const _SplitContext*)context;
+		for(size_t k=first; k<last; ++k)
+		{
+			_SplitChunk& c = (*ctx.chunks)[k];
+			size_t i = _EscapedAt(ctx.text, c.begin) ? c.begin+1 : c.begin;
+			c.quotes = 0;
+			while( (i = _ScanRange<'"','\\'>(ctx.text, i, c.end, false)) != JSONValue::npos )
+			{
+				if( ctx.text[i] == '"' ) { ++c.quotes; }
+				else                     { ++i; }
+				++i;
+			}
+		}
+	}
+	inline void _WalkChunks(void* context, size_t first, size_t last)
+	{
+		const _SplitContext& ctx = *(const _SplitContext*)context;
+		const Char* p = ctx.text;
+		for(size_t k=first; k<last; ++k)
+		{
+			_SplitChunk& c = (*ctx.chunks)[k];
+			bool inString = c.inString;
+			int depth = c.depth;
+			size_t i = inString && _EscapedAt(p, c.begin) ? c.begin+1 : c.begin;
+			while( i < c.end )
+			{
+				if( inString )
+				{
+					i = _ScanRange<'"','\\'>(p, i, c.end, false);
+					if( i == JSONValue::npos ) { break; }
+					if( p[i] == '"' ) { inString = false; }
+					else              { ++i; }
+					++i;
+					continue;
+				}
+				i = ctx.lines ? _ScanRange<'"','\n'>(p, i, c.end, false)
+				              : _ScanRange<'"',',','[',']','{','}'>(p, i, c.end, false);
+				if( i == JSONValue::npos ) { break; }
+				switch( p[i] )
+				{
+				case '"': inString = true; break;
+				case '[':
+				case '{': ++depth; break;
+				case ']':
+				case '}': if( --depth == 0 && ctx.emit ) { c.boundaries.push_back(i); } break;
+				default : if( ctx.emit && (ctx.lines || depth == 1) ) { c.boundaries.push_back(i); } break;//',' or '\n'
+				}
+				++i;
+			}
+			c.depthDelta = depth - c.depth;
+		}
+	}
+	inline JSONValue _Trimmed(const Char* p, size_t begin, size_t end)
+	{
+		while( begin < end && _In(p[begin], ' ', '\t', '\r', '\n', '\f', '\b') ) { ++begin; }
+		while( begin < end && _In(p[end-1], ' ', '\t', '\r', '\n', '\f', '\b') ) { --end; }
+		return begin < end ? JSONValue(p + begin, end - begin) : JSONValue();
+	}
+	inline bool _Split(const JSONValue& v, size_t begin, bool lines, std::vector<JSONValue>& out_values, int threads, bool& out_error)
+	{
+		out_values.clear();
+		const Char* p = v.data();
+		size_t n = v.size();
+		const size_t minChunk = 1 << 16;//below this, threading costs more than it saves
+		size_t count = (size_t)_ThreadCount(threads);
+		if( count > (n - begin) / minChunk ) { count = (n - begin) / minChunk; }
+		if( count < 1 ) { count = 1; }
+		std::vector<_SplitChunk> chunks(count);
+		for(size_t k=0; k<count; ++k)
+		{
+			chunks[k].begin = begin + (n - begin) * k / count;
+			chunks[k].end   = begin + (n - begin) * (k+1) / count;
+		}
+		_SplitContext ctx = { p, &chunks, lines, false };
+		_ParallelFor(count, threads, &_CountQuotes, &ctx);
+		bool inString = false;
+		for(size_t k=0; k<count; ++k)
+		{
+			chunks[k].inString = inString;
+			chunks[k].depth = 1;
+			inString ^= (chunks[k].quotes & 1) != 0;
+		}
+		if( inString ) { LOCJSON_EXCEPTION("Unterminated string"); out_error = true; return false; }
+		if( !lines )
+		{
+			_ParallelFor(count, threads, &_WalkChunks, &ctx);
+			for(size_t k=1; k<count; ++k)
+				chunks[k].depth = chunks[k-1].depth + chunks[k-1].depthDelta;
+			if( chunks[count-1].depth + chunks[count-1].depthDelta != 0 ) { LOCJSON_EXCEPTION("Unbalanced brackets"); out_error = true; return false; }
+		}
+		ctx.emit = true;
+		_ParallelFor(count, threads, &_WalkChunks, &ctx);
+
+		size_t total = 0;
+		for(size_t k=0; k<count; ++k)
+			total += chunks[k].boundaries.size();
+		out_values.reserve(total + 1);
+		size_t previous = begin;
+		for(size_t k=0; k<count; ++k)
+		{
+			for(size_t b=0; b<chunks[k].boundaries.size(); ++b)
+			{
+				size_t boundary = chunks[k].boundaries[b];
+				JSONValue value = _Trimmed(p, previous, boundary);
+				previous = boundary + 1;
+				if( !value.empty() ) { out_values.push_back(value); }
+				else if( !lines && !(out_values.empty() && p[boundary] == ']') ) { LOCJSON_EXCEPTION("Missing array element"); out_error = true; return false; }
+				if( !lines && p[boundary] == ']' )
+				{
+					if( !_Trimmed(p, previous, n).empty() ) { LOCJSON_EXCEPTION("Text after array"); out_error = true; return false; }
+					return true;
+				}
+			}
+		}
+		if( !lines ) { LOCJSON_EXCEPTION("Unterminated array"); out_error = true; return false; }
+		JSONValue value = _Trimmed(p, previous, n);
+		if( !value.empty() ) { out_values.push_back(value); }
+		return true;
+	}
+	LOCJSON_FUNCTION bool SplitArray(const JSONValue& array, std::vector<JSONValue>& out_elements, int threads, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatSplit);
+		size_t i = _FindFirstNotOf<' ','\t','\r','\n','\f','\b'>(array, 0);
+		if( i == JSONValue::npos || array[i] != '[' ) { LOCJSON_EXCEPTION("Expected array"); out_error = true; out_elements.clear(); return false; }
+		return _Split(array, i+1, false, out_elements, threads, out_error);
+	}
+	LOCJSON_FUNCTION bool SplitLines(const JSONValue& text, std::vector<JSONValue>& out_records, int threads, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatSplit);
+		return _Split(text, 0, true, out_records, threads, out_error);
+	}
+
+	inline size_t SkipNumber(const JSONValue& v, size_t i, bool& out_error)
+	{
+		size_t j = v.find_first_not_of(LOCJSON_LITERAL("+-0123456789.eE"), i);
+		if( i==j ) { LOCJSON_EXCEPTION("Invalid Number"); out_error = true; return i+1; }
+		return j;
+	}
+	inline size_t SkipString(const JSONValue& v, size_t i, bool& out_error)
+	{
+		if( v[i] != '"' ) { LOCJSON_EXCEPTION("Invalid String"); out_error = true; return i+1; }
+		for(++i; i<v.size();)
+		{
+			i = _FindFirstOf<'"','\\'>(v, i);
+			if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated String"); out_error = true; return i; }
+			if( v[i] == '"' ) { break; }
+			if( i+1 < v.size() )
 			{
 				switch(v[i+1])
 				{
-				case '\\': case 'b': case 'f': case 'n': case 'r': case 't': case '"': i = i+2; continue;
+				case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't': case '"': i = i+2; continue;
 				case 'u': i = i+6; continue;
 				}
 			}
@@ -332,176 +1933,2356 @@ namespace locjson
 		}
 		LOCJSON_EXCEPTION("Invalid Value"); out_error = true; return i+1;
 	}
-	inline size_t SkipObject(const JSONValue& v, size_t i, bool& out_error);
-	inline size_t SkipArray(const JSONValue& v, size_t i, bool& out_error)
+	// Moves `i` to the next array element and returns true, or returns false with `i` on the closing bracket (or npos).
+	inline bool _NextElement(const JSONValue& v, size_t& i, bool& out_error)
 	{
-		if( v[i] != '[' ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return i+1; }
-		++i;
-		for(; i<v.size();)
+		i = _SkipSeparators(v, i);
+		if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated array"); out_error = true; return false; }
+		return v[i] != ']';
+	}
+	// Moves `i` to the opening quote of the next key and returns true, or returns false with `i` on the closing brace (or npos).
+	inline bool _NextMember(const JSONValue& v, size_t& i, size_t& out_keyEnd, size_t& out_valueBegin, bool& out_error)
+	{
+		i = _SkipSeparators(v, i);
+		if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated object"); out_error = true; return false; }
+		if( v[i] == '}' ) { return false; }
+		if( v[i] != '"' ) { LOCJSON_EXCEPTION("Invalid object key"); out_error = true; i = JSONValue::npos; return false; }
+		out_keyEnd = SkipString(v, i, out_error);
+		out_valueBegin = _SkipKeySeparators(v, out_keyEnd);
+		if( out_valueBegin == JSONValue::npos ) { LOCJSON_EXCEPTION("No value following object key"); out_error = true; i = JSONValue::npos; return false; }
+		return true;
+	}
+	// Iterative: each open object/array costs one bit of a fixed-size stack rather than a call frame.
+	inline size_t SkipValue(const JSONValue& v, size_t i, bool& out_error)
+	{
+		LOCJSON_STAT_SKIP();
+		_Nesting nesting;
+		size_t keyEnd, valueBegin;
+		for(;;)
 		{
-			i = v.find_first_not_of(LOCJSON_LITERAL(", \t\r\n\f\b"), i);
-			if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated array"); out_error = true; return i; }
 			switch( v[i] )
 			{
-			case ']': return i+1;
-			case '{': i = SkipObject(v, i, out_error); break;
-			case '[': i = SkipArray(v, i, out_error); break;
+			case '{': case '[':
+				if( !nesting.Push(v[i] == '{') ) { LOCJSON_EXCEPTION("Nesting too deep"); out_error = true; return JSONValue::npos; }
+				++i;
+				break;
 			case '"': i = SkipString(v, i, out_error); break;
 			case 't': case 'f': case 'n': i = SkipBoolNull(v, i, out_error); break;
 			default:  i = SkipNumber(v, i, out_error); break;
 			}
+			//move on to the next value, closing the containers that end first
+			for(;; ++i, --nesting.depth)
+			{
+				if( nesting.depth == 0 ) { return i; }
+				bool object = nesting.InObject();
+				if( object ? _NextMember(v, i, keyEnd, valueBegin, out_error) : _NextElement(v, i, out_error) )
+				{
+					if( object ) { i = valueBegin; }
+					break;
+				}
+				if( i == JSONValue::npos ) { return i; }
+			}
 		}
-		LOCJSON_EXCEPTION("Unterminated array");
-		out_error = true;
-		return i == JSONValue::npos ? i : i+1;
+	}
+	inline size_t SkipArray(const JSONValue& v, size_t i, bool& out_error)
+	{
+		if( v[i] != '[' ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return i+1; }
+		return SkipValue(v, i, out_error);
 	}
 	inline size_t SkipObject(const JSONValue& v, size_t i, bool& out_error)
 	{
 		if( v[i] != '{' ) { LOCJSON_EXCEPTION("Invalid object"); out_error = true; return i+1; }
-		for(; i<v.size();)
-		{
-			size_t keyBegin = v.find_first_of(LOCJSON_LITERAL("\"}"), i);
-			if( keyBegin == JSONValue::npos || v[keyBegin] == '}' ) { break; }//no more keys
-			size_t keyEnd = v.find_first_of('"', keyBegin+1);
-			if( keyEnd == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated string"); out_error = true; break; }
-			size_t valueBegin = v.find_first_not_of(LOCJSON_LITERAL(" \t\r\n\f\b:"), keyEnd+1);
-			if( valueBegin == JSONValue::npos ) { LOCJSON_EXCEPTION("No value following object key"); out_error = true; break; }
-			Char value0 = v[valueBegin];
-			switch(value0)
-			{
-			case '{': i = SkipObject(v, valueBegin, out_error); break;
-			case '[': i = SkipArray(v, valueBegin, out_error); break;
-			case '"': i = SkipString(v, valueBegin, out_error); break;
-			case 't': case 'f': case 'n': i = SkipBoolNull(v, i, out_error); break;
-			default:  i = SkipNumber(v, valueBegin, out_error); break;
+		return SkipValue(v, i, out_error);
+	}
+	// Skips the value at `i` tracking only strings and bracket depth, without looking at the values inside it.
+	// Mismatched brackets and malformed scalars go unnoticed; unterminated strings and containers are errors.
+	inline size_t SkipSubtree(const JSONValue& v, size_t i, bool& out_error)
+	{
+		LOCJSON_STAT_SKIP();
+		const Char* p = v.data();
+		size_t n = v.size(), depth = 0;
+		for(;; ++i)
+		{
+			i = depth ? _ScanRange<'"','[',']','{','}'>(p, i, n, false) : i;
+			if( i >= n ) { LOCJSON_EXCEPTION("Unterminated value"); out_error = true; return JSONValue::npos; }
+			switch( p[i] )
+			{
+			case '"':
+				for(++i; (i = _ScanRange<'"','\\'>(p, i, n, false)) != JSONValue::npos && p[i] == '\\'; i += 2) {}
+				if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated String"); out_error = true; return i; }
+				break;
+			case '[': case '{': ++depth; break;
+			case ']': case '}':
+				if( depth == 0 ) { LOCJSON_EXCEPTION("Invalid Value"); out_error = true; return i+1; }
+				--depth;
+				break;
+			default:
+				{
+					size_t end = _ScanRange<',',']','}',' ','\t','\r','\n'>(p, i, n, false);
+					if( end == i ) { LOCJSON_EXCEPTION("Invalid Value"); out_error = true; return i+1; }
+					return end == JSONValue::npos ? n : end;
+				}
 			}
+			if( depth == 0 ) { return i+1; }
 		}
-		return i == JSONValue::npos ? i : i+1;
+	}
+	// The skip used when passing over values that aren't being read
+	inline size_t _SkipOver(const JSONValue& v, size_t i, bool& out_error)
+	{
+#if defined(LOCJSON_FAST_SKIP)
+		return SkipSubtree(v, i, out_error);
+#else
+		return SkipValue(v, i, out_error);
+#endif
+	}
+	// Out-of-line tokenizer steps for the ParseSax template
+	LOCJSON_FUNCTION size_t _SaxSkip(const JSONValue& v, size_t i, bool& out_error)                                          { return _SkipOver(v, i, out_error); }
+	LOCJSON_FUNCTION bool   _SaxNextElement(const JSONValue& v, size_t& i, bool& out_error)                                  { return _NextElement(v, i, out_error); }
+	LOCJSON_FUNCTION bool   _SaxNextMember(const JSONValue& v, size_t& i, size_t& keyEnd, size_t& valueBegin, bool& out_error) { return _NextMember(v, i, keyEnd, valueBegin, out_error); }
+	// Skips the string, number or literal at `i`, which must be followed by whitespace, a separator, a closing bracket
+	// or the end of the document. Returns npos if it is malformed.
+	LOCJSON_FUNCTION size_t _SaxScalar(const JSONValue& v, size_t i, bool& out_error)
+	{
+		bool error = false;
+		size_t end;
+		switch( v[i] )
+		{
+		case '"': end = SkipString(v, i, error); break;
+		case 't': case 'f': case 'n': end = SkipBoolNull(v, i, error); break;
+		default:  end = SkipNumber(v, i, error); break;
+		}
+		if( end == JSONValue::npos && !error ) { end = v.size(); }//a number ending the document
+		if( !error && end < v.size() && !_In(v[end], ' ', '\t', '\r', '\n', ',', ']', '}') ) { LOCJSON_EXCEPTION("Invalid Value"); error = true; }
+		if( error ) { out_error = true; return JSONValue::npos; }
+		return end;
 	}
 
 	LOCJSON_FUNCTION Int32 LookupInt32(const JSONValue& v, const Char* field, bool& out_error)     { return AsInt32( LookupValue(v, field, out_error), out_error); }
 	LOCJSON_FUNCTION UInt32 LookupUInt32(const JSONValue& v, const Char* field, bool& out_error)   { return AsUInt32(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION Int64 LookupInt64(const JSONValue& v, const Char* field, bool& out_error)     { return AsInt64( LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION UInt64 LookupUInt64(const JSONValue& v, const Char* field, bool& out_error)   { return AsUInt64(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION double LookupDouble(const JSONValue& v, const Char* field, bool& out_error)   { return AsDouble(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION bool LookupBool(const JSONValue& v, const Char* field, bool& out_error)       { return AsBool(  LookupValue(v, field, out_error), out_error); }
 	LOCJSON_FUNCTION String LookupString(const JSONValue& v, const Char* field, bool& out_error)   { return AsString(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION StringView LookupStringView(const JSONValue& v, const Char* field, Char* buffer, size_t capacity, bool& out_error) { return AsStringView(LookupValue(v, field, out_error), buffer, capacity, out_error); }
 	LOCJSON_FUNCTION JSONArray LookupArray(const JSONValue& v, const Char* field, bool& out_error) { return AsArray(LookupValue(v, field, out_error), out_error); }
 	LOCJSON_FUNCTION bool HasField(const JSONValue& v, const Char* field, bool& out_error)         { return LOCJSON_LITERAL("") != LookupValue(v, field, out_error); }
 	LOCJSON_FUNCTION bool HasArrayField(const JSONValue& v, const Char* field, bool& out_error)    { return IsArray(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION bool HasNullField(const JSONValue& v, const Char* field, bool& out_error)     { return IsNull(LookupValue(v, field, out_error), out_error); }
 	LOCJSON_FUNCTION JSONValue LookupValue(const JSONValue& v, const Char* field, bool& out_error)
 	{
+		LOCJSON_STAT_SCOPE(JSONStatLookupValue);
 		if( v.length() < 1 || v[0] != '{' ) { out_error = true; return LOCJSON_LITERAL(""); }
 		size_t fieldLen = LOCJSON_STRLEN(field);
-		for(size_t i=0; i<v.size();)
-		{
-			size_t keyBegin = v.find_first_of(LOCJSON_LITERAL("\"}"), i);
-			if( keyBegin == JSONValue::npos || v[keyBegin] == '}' ) { break; }//no more keys
-			++keyBegin;
-			size_t keyEnd = v.find_first_of('"', keyBegin);
-			if( keyEnd == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated string"); out_error = true; break; }
-			size_t valueBegin = v.find_first_not_of(LOCJSON_LITERAL(" \t\r\n\f\b:"), keyEnd+1);
-			if( valueBegin == JSONValue::npos ) { LOCJSON_EXCEPTION("No value following object key"); out_error = true; break; }
-			size_t keyLen = keyEnd-keyBegin;
-			bool correctKey = fieldLen == keyLen && 0==v.compare(keyBegin, keyLen, field);
+		size_t keyEnd, valueBegin;
+		for(size_t i=1; _NextMember(v, i, keyEnd, valueBegin, out_error); i = _SkipOver(v, valueBegin, out_error))
+		{
+			size_t keyLen = keyEnd-i-2;
+			bool correctKey = fieldLen == keyLen && 0==v.compare(i+1, keyLen, field);
 			if( correctKey )
 				return v.substr(valueBegin);
-			Char value0 = v[valueBegin];
-			switch(value0)
-			{
-			case '{': i = SkipObject(v, valueBegin, out_error); break;
-			case '[': i = SkipArray( v, valueBegin, out_error); break;
-			case '"': i = SkipString(v, valueBegin, out_error); break;
-			case 't': case 'f': case 'n': i = SkipBoolNull(v, valueBegin, out_error); break;
-			default:  i = SkipNumber(v, valueBegin, out_error); break;
-			}
 		}
 		return LOCJSON_LITERAL("");
 	}
-	LOCJSON_FUNCTION Int32  AsInt32(const JSONValue& v, bool& out_error)
+	LOCJSON_FUNCTION int LookupFields(const JSONValue& v, JSONField* fields, int count, bool& out_error)
 	{
-		const Char* numeric = LOCJSON_LITERAL("-0123456789");
-		size_t begin = v.find_first_of(numeric, 0);
-		if( begin != 0 ) { LOCJSON_EXCEPTION("Invalid number"); out_error = true; return 0; }
-		size_t pos = v.find_first_not_of(numeric, 0);
-		if( pos == 0 ) { LOCJSON_EXCEPTION("Invalid number"); out_error = true; return 0; }
-		JSONValue n = pos == JSONValue::npos ? v : v.substr(0, pos);
-		return (Int32)LOCJSON_STRTOL(n.data(), 0, 10);
+		LOCJSON_STAT_SCOPE(JSONStatLookupFields);
+		for(int f=0; f<count; ++f)
+			fields[f].found = fields[f].error = false;
+		if( v.length() < 1 || v[0] != '{' ) { out_error = true; return 0; }
+		int remaining = count;
+		size_t keyEnd, valueBegin;
+		for(size_t i=1; remaining && _NextMember(v, i, keyEnd, valueBegin, out_error);)
+		{
+			size_t keyLen = keyEnd-i-2;
+			size_t valueEnd = _SkipOver(v, valueBegin, out_error);
+			if( valueEnd == JSONValue::npos ) { break; }
+			for(int f=0; f<count; ++f)
+			{
+				JSONField& field = fields[f];
+				if( field.found || field.length != keyLen || 0!=v.compare(i+1, keyLen, field.name) )
+					continue;
+				JSONValue value = v.substr(valueBegin, valueEnd-valueBegin);
+				switch( field.type )
+				{
+				case JSONFieldInt32:  *(Int32*)field.out     = AsInt32(value, field.error);  break;
+				case JSONFieldUInt32: *(UInt32*)field.out    = AsUInt32(value, field.error); break;
+				case JSONFieldInt64:  *(Int64*)field.out     = AsInt64(value, field.error);  break;
+				case JSONFieldUInt64: *(UInt64*)field.out    = AsUInt64(value, field.error); break;
+				case JSONFieldDouble: *(double*)field.out    = AsDouble(value, field.error); break;
+				case JSONFieldBool:   *(bool*)field.out      = AsBool(value, field.error);   break;
+				case JSONFieldString: *(String*)field.out    = AsString(value, field.error); break;
+				case JSONFieldValue:  *(JSONValue*)field.out = value;                        break;
+				case JSONFieldArray:  *(JSONArray*)field.out = AsArray(value, field.error);  break;
+				}
+				if( field.error ) { out_error = true; }
+				field.found = true;
+				--remaining;
+				break;
+			}
+			i = valueEnd;
+		}
+		return count - remaining;
 	}
-	LOCJSON_FUNCTION UInt32 AsUInt32(const JSONValue& v, bool& out_error) { return (UInt32)AsInt32(v, out_error); }
-	LOCJSON_FUNCTION String AsString(const JSONValue& v, bool& out_error)
+
+	LOCJSON_FUNCTION bool CompilePath(const Char* pointer, JSONPath& out_path, bool& out_error)
 	{
-		if( v.length() < 1 || v[0] != '"' ) { LOCJSON_EXCEPTION("Casting non-string value to string"); out_error = true; return String(LOCJSON_LITERAL("")); }
-		size_t pos = v.find('"', 1);
-		if( pos == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated string"); out_error = true; return String(LOCJSON_LITERAL("")); }
-		return String(v.substr(1, pos-1));
+		out_path.tokens.clear();
+		if( !*pointer ) { return true; }//the empty pointer refers to the whole document
+		if( *pointer != '/' ) { LOCJSON_EXCEPTION("JSON Pointer must start with '/'"); out_error = true; return false; }
+		for(const Char* c = pointer; *c; )
+		{
+			JSONPathToken token;
+			for(++c; *c && *c != '/'; ++c)
+			{
+				if( *c != '~' ) { token.name += *c; continue; }
+				++c;
+				if( *c == '0' )      { token.name += '~'; }
+				else if( *c == '1' ) { token.name += '/'; }
+				else { LOCJSON_EXCEPTION("Invalid JSON Pointer escape"); out_error = true; out_path.tokens.clear(); return false; }
+			}
+			token.wildcard = token.name.size() == 1 && token.name[0] == '*';
+			token.index = token.name.empty() || token.name.size() > 9 || (token.name[0] == '0' && token.name.size() > 1) ? -1 : 0;
+			for(size_t d=0; d<token.name.size() && token.index >= 0; ++d)
+				token.index = token.name[d] >= '0' && token.name[d] <= '9' ? token.index*10 + (token.name[d] - '0') : -1;
+			out_path.tokens.push_back(token);
+		}
+		return true;
 	}
-	LOCJSON_FUNCTION JSONArray AsArray(const JSONValue& v, bool& out_error) { if(!IsArray(v, out_error)) { LOCJSON_EXCEPTION("Casting non-array value to array"); out_error = true; } return v; }
-	LOCJSON_FUNCTION bool IsArray(const JSONValue& v, bool& out_error)
+	struct _PathQuery
 	{
-		if( v.length() < 1 ) { out_error = true; return false; }
-		return v[0] == '[';
+		const JSONPath* paths;
+		std::vector<JSONPathMatch>* matches;
+		std::vector<int> active;  // a stack of the paths that match down to each level of the walk
+		int  remaining;           // matches still possible, or -1 if a wildcard makes that unbounded
+		int  pending;             // matches whose value's end hasn't been reached yet
+		bool done;
+	};
+	inline bool _KeyMatches(const JSONValue& v, size_t keyBegin, size_t keyEnd, const String& name)
+	{
+		size_t length = keyEnd - keyBegin - 2;
+		if( length == name.size() && 0 == v.compare(keyBegin + 1, length, name) ) { return true; }
+		// Escapes only ever shorten a key, so only a longer key with a backslash in it can still match
+		if( length <= name.size() || _ScanRange<'\\'>(v.data(), keyBegin + 1, keyEnd - 1, false) == JSONValue::npos ) { return false; }
+		bool error = false;
+		return AsString(v.substr(keyBegin, keyEnd - keyBegin), error) == name;
 	}
-	LOCJSON_FUNCTION bool IsObject(const JSONValue& v, bool& out_error)
+	// Pushes the paths in active[first, last) whose token at `depth` matches this child (an array index, or a key)
+	inline void _QueryChild(_PathQuery& q, size_t first, size_t last, size_t depth, const JSONValue& v, size_t keyBegin, size_t keyEnd, Int32 index)
 	{
-		if( v.length() < 1 ) { out_error = true; return false; }
-		return v[0] == '{';
+		for(size_t k=first; k<last; ++k)
+		{
+			const JSONPath& path = q.paths[q.active[k]];
+			if( path.tokens.size() <= depth ) { continue; }//matched at this level, nothing more to find below it
+			const JSONPathToken& token = path.tokens[depth];
+			if( token.wildcard || (index >= 0 ? token.index == index : _KeyMatches(v, keyBegin, keyEnd, token.name)) )
+				q.active.push_back(q.active[k]);
+		}
 	}
-
-	LOCJSON_FUNCTION int ArraySize(const JSONArray& v, bool& out_error)
+	// Walks the value at `i`, for which the paths in active[first, end) have matched every token before `depth`.
+	// Returns one past the end of the value, or npos once the query is done and no match needs the end.
+	inline size_t _QueryValue(const JSONValue& v, size_t i, _PathQuery& q, size_t first, size_t depth, bool& out_error)
 	{
-		if( v[0] != '[' ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return 0; }
-		int count = 0;
-		for(size_t i=1; i<v.size();)
+		size_t last = q.active.size();
+		size_t firstMatch = q.matches->size();
+		bool deeper = false;
+		for(size_t k=first; k<last; ++k)
 		{
-			i = v.find_first_not_of(LOCJSON_LITERAL(", \t\r\n\f\b"), i);
-			if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated array"); out_error = true; return count; }
-			switch( v[i] )
+			if( q.paths[q.active[k]].tokens.size() > depth ) { deeper = true; continue; }
+			JSONPathMatch match = { q.active[k], JSONValue() };//the value is filled in once its end is known
+			q.matches->push_back(match);
+			if( q.remaining > 0 && --q.remaining == 0 ) { q.done = true; }
+		}
+		int matched = (int)(q.matches->size() - firstMatch);
+		q.pending += matched;
+		size_t end = i;
+		if( !deeper || q.done || (v[i] != '[' && v[i] != '{') )
+		{
+			end = _SkipOver(v, i, out_error);
+		}
+		else if( v[i] == '[' )
+		{
+			Int32 index = 0;
+			for(++end; _NextElement(v, end, out_error); ++index)
 			{
-			case ']': return count;
-			case '{': i = SkipObject(v, i, out_error); count++; break;
-			case '[': i = SkipArray(v, i, out_error);  count++; break;
-			case '"': i = SkipString(v, i, out_error); count++; break;
-			case 't': case 'f': case 'n': i = SkipBoolNull(v, i, out_error); break;
-			default:  i = SkipNumber(v, i, out_error); count++; break;
+				size_t top = q.active.size();
+				if( !q.done ) { _QueryChild(q, first, last, depth, v, 0, 0, index); }
+				end = q.active.size() > top ? _QueryValue(v, end, q, top, depth+1, out_error) : _SkipOver(v, end, out_error);
+				q.active.resize(top);
+				if( q.done && !q.pending ) { return JSONValue::npos; }
 			}
+			if( end != JSONValue::npos ) { ++end; }
 		}
-		return count;
-	}
-	LOCJSON_FUNCTION JSONValue IndexArray(const JSONArray& v, int index, bool& out_error)
-	{
-		if( v[0] != '[' ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return LOCJSON_LITERAL(""); }
-		int count = 0;
-		for(size_t i=1; i<v.size();)
+		else
 		{
-			i = v.find_first_not_of(LOCJSON_LITERAL(", \t\r\n\f\b"), i);
-			if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated array"); out_error = true; return LOCJSON_LITERAL(""); }
-			if( count == index )
-				return v.substr(i);
-			switch( v[i] )
+			size_t keyEnd, valueBegin;
+			for(++end; _NextMember(v, end, keyEnd, valueBegin, out_error);)
 			{
-			case ']': goto err;
-			case '{': i = SkipObject(v, i, out_error); count++; break;
-			case '[': i = SkipArray(v, i, out_error);  count++; break;
-			case '"': i = SkipString(v, i, out_error); count++; break;
-			case 't': case 'f': case 'n': i = SkipBoolNull(v, i, out_error); break;
-			default:  i = SkipNumber(v, i, out_error); count++; break;
+				size_t top = q.active.size();
+				if( !q.done ) { _QueryChild(q, first, last, depth, v, end, keyEnd, -1); }
+				end = q.active.size() > top ? _QueryValue(v, valueBegin, q, top, depth+1, out_error) : _SkipOver(v, valueBegin, out_error);
+				q.active.resize(top);
+				if( q.done && !q.pending ) { return JSONValue::npos; }
 			}
+			if( end != JSONValue::npos ) { ++end; }
 		}
-	err:
-		LOCJSON_EXCEPTION("Array index out of bounds"); 
-		out_error = true;
-		return LOCJSON_LITERAL("");
+		for(int m=0; m<matched; ++m)
+			(*q.matches)[firstMatch + m].value = v.substr(i, end == JSONValue::npos ? end : end - i);
+		q.pending -= matched;
+		return end;
 	}
-
-	LOCJSON_FUNCTION                 void _AddKey(JSONBuilder& b, const Char* key)                      { if(!b.empty) { b.s << LOCJSON_LITERAL(", "); } b.empty = false; b.s << '"' << key << LOCJSON_LITERAL("\": "); }
-	LOCJSON_FUNCTION                 void BeginObject(JSONBuilder& b)                                   { b.s << '{'; }
-	LOCJSON_FUNCTION                 void EndObject(JSONBuilder& b)                                     { b.s << '}'; }
-	LOCJSON_FUNCTION                 void _AddValues(JSONBuilder& b)                                    {}
-	LOCJSON_FUNCTION                 void _AddValues(JSONBuilder& b, const char* arg)                   { b.s << '"' << arg << '"'; }
-	LOCJSON_FUNCTION                 void AddString(JSONBuilder& b, const Char* key, const Char* value) { _AddKey(b, key); b.s << '"' << value << '"'; }
-#else
-	LOCJSON_FUNCTION                 void _AddKey(JSONBuilder& b, const Char* key);
-	LOCJSON_FUNCTION                 void _AddValues(JSONBuilder& b);
-	LOCJSON_FUNCTION                 void _AddValues(JSONBuilder& b, const char* arg;
-#endif
-	template<class T>                void _AddValues(JSONBuilder& b, T arg)                              { b.s << arg; }
-	template<class T, class... Args> void _AddValues(JSONBuilder& b, T arg0, Args... args)               { _AddValues(b, arg0); b.s << LOCJSON_LITERAL(", "); _AddValues(b.args...); }
-	template<class... Args>          void AddArray(JSONBuilder& b, const Char* key, Args... args)       { _AddKey(b, key); b.s << '['; _AddValues(b, args...); b.s << ']'; }
-}
+	inline int _QueryPaths(const JSONValue& v, const JSONPath* paths, int count, std::vector<JSONPathMatch>& out_matches, bool firstOnly, bool& out_error)
+	{
+		size_t before = out_matches.size();
+		size_t i = _FindFirstNotOf<' ','\t','\r','\n','\f','\b'>(v, 0);
+		if( i == JSONValue::npos || count <= 0 ) { return 0; }
+		_PathQuery q;
+		q.paths = paths;
+		q.matches = &out_matches;
+		q.remaining = firstOnly ? 1 : count;
+		q.pending = 0;
+		q.done = false;
+		for(int p=0; p<count; ++p)
+		{
+			q.active.push_back(p);
+			for(size_t t=0; t<paths[p].tokens.size() && !firstOnly; ++t)
+				if( paths[p].tokens[t].wildcard ) { q.remaining = -1; }
+		}
+		_QueryValue(v, i, q, 0, 0, out_error);
+		return (int)(out_matches.size() - before);
+	}
+	LOCJSON_FUNCTION JSONValue QueryPath(const JSONValue& v, const JSONPath& path, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatQueryPaths);
+		std::vector<JSONPathMatch> matches;
+		_QueryPaths(v, &path, 1, matches, true, out_error);
+		return matches.empty() ? JSONValue() : matches[0].value;
+	}
+	LOCJSON_FUNCTION int QueryPaths(const JSONValue& v, const JSONPath* paths, int count, std::vector<JSONPathMatch>& out_matches, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatQueryPaths);
+		return _QueryPaths(v, paths, count, out_matches, false, out_error);
+	}
+	// A JSON number split into its significant digits and a power of ten, e.g. "-1.25e3" is -(125 * 10^1)
+	struct _Number
+	{
+		UInt64 mantissa;
+		int    exponent;
+		bool   negative;
+		bool   integer;  // no fraction or exponent
+		bool   overflow; // there were more significant digits than fit in the mantissa
+		size_t end;
+	};
+#if !defined(LOCJSON_NO_SWAR) && (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64))
+	// Checks/converts eight ASCII digits at once, loaded as a little-endian 64-bit word
+	inline bool   _IsEightDigits(UInt64 x) { return 0 == (((x + 0x4646464646464646ull) | (x - 0x3030303030303030ull)) & 0x8080808080808080ull); }
+	inline UInt32 _EightDigits(UInt64 x)
+	{
+		x -= 0x3030303030303030ull;
+		x = (x * 10) + (x >> 8);
+		return (UInt32)((((x & 0x000000FF000000FFull) * 0x000F424000000064ull) + (((x >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >> 32);
+	}
+	#define LOCJSON_SWAR
+#endif
+	inline bool _IsDigit(Char c) { return c >= '0' && c <= '9'; }
+	inline size_t _ParseDigits(const JSONValue& v, size_t i, _Number& out, bool fraction)
+	{
+		const Char* p = v.data();
+		size_t n = v.size();
+#if defined(LOCJSON_SWAR)
+		for(; sizeof(Char) == 1 && i+8 <= n && out.mantissa < 100000000000ull; i += 8)
+		{
+			UInt64 chunk;
+			memcpy(&chunk, p+i, 8);
+			if( !_IsEightDigits(chunk) ) { break; }
+			out.mantissa = out.mantissa * 100000000u + _EightDigits(chunk);
+			if( fraction ) { out.exponent -= 8; }
+		}
+#endif
+		for(; i<n && _IsDigit(p[i]); ++i)
+		{
+			unsigned digit = (unsigned)(p[i] - '0');
+			if( out.mantissa <= (~(UInt64)0 - digit) / 10 ) { out.mantissa = out.mantissa * 10 + digit; if( fraction ) { --out.exponent; } }
+			else { out.overflow = true; if( !fraction ) { ++out.exponent; } }
+		}
+		return i;
+	}
+	inline bool _ParseNumber(const JSONValue& v, _Number& out)
+	{
+		_Number num = { 0, 0, false, true, false, 0 };
+		size_t i = 0, n = v.size();
+		if( i<n && v[i] == '-' ) { num.negative = true; ++i; }
+		if( i>=n || !_IsDigit(v[i]) ) { return false; }
+		i = v[i] == '0' ? i+1 : _ParseDigits(v, i, num, false);
+		if( i<n && v[i] == '.' )
+		{
+			if( ++i>=n || !_IsDigit(v[i]) ) { return false; }
+			i = _ParseDigits(v, i, num, true);
+			num.integer = false;
+		}
+		if( i<n && (v[i] == 'e' || v[i] == 'E') )
+		{
+			bool negative = false;
+			if( ++i<n && (v[i] == '+' || v[i] == '-') ) { negative = v[i++] == '-'; }
+			if( i>=n || !_IsDigit(v[i]) ) { return false; }
+			int exponent = 0;
+			for(; i<n && _IsDigit(v[i]); ++i)
+				if( exponent < 100000 ) { exponent = exponent * 10 + (v[i] - '0'); }
+			num.exponent += negative ? -exponent : exponent;
+			num.integer = false;
+		}
+		if( i<n && !_In(v[i], ',', ']', '}', ' ', '\t', '\r', '\n', '\f', '\b') ) { return false; }//e.g. "01" or "1x"
+		num.end = i;
+		out = num;
+		return true;
+	}
+	inline UInt64 _AsInteger(const JSONValue& v, UInt64 maxPositive, UInt64 maxNegative, bool& out_negative, bool& out_error)
+	{
+		_Number num;
+		if( !_ParseNumber(v, num) ) { LOCJSON_EXCEPTION("Invalid number"); out_error = true; return 0; }
+		if( !num.integer ) { LOCJSON_EXCEPTION("Number is not an integer"); out_error = true; return 0; }
+		if( num.overflow || num.mantissa > (num.negative ? maxNegative : maxPositive) ) { LOCJSON_EXCEPTION("Integer out of range"); out_error = true; return 0; }
+		out_negative = num.negative;
+		return num.mantissa;
+	}
+	LOCJSON_FUNCTION Int32 AsInt32(const JSONValue& v, bool& out_error)
+	{
+		bool negative = false;
+		UInt64 m = _AsInteger(v, 0x7FFFFFFFu, 0x80000000u, negative, out_error);
+		return negative ? (Int32)(0u - (UInt32)m) : (Int32)m;
+	}
+	LOCJSON_FUNCTION UInt32 AsUInt32(const JSONValue& v, bool& out_error)
+	{
+		bool negative = false;
+		return (UInt32)_AsInteger(v, 0xFFFFFFFFu, 0, negative, out_error);
+	}
+	LOCJSON_FUNCTION Int64 AsInt64(const JSONValue& v, bool& out_error)
+	{
+		bool negative = false;
+		UInt64 m = _AsInteger(v, 0x7FFFFFFFFFFFFFFFull, 0x8000000000000000ull, negative, out_error);
+		return negative ? (Int64)(0u - m) : (Int64)m;
+	}
+	LOCJSON_FUNCTION UInt64 AsUInt64(const JSONValue& v, bool& out_error)
+	{
+		bool negative = false;
+		return _AsInteger(v, ~(UInt64)0, 0, negative, out_error);
+	}
+	LOCJSON_FUNCTION double AsDouble(const JSONValue& v, bool& out_error)
+	{
+		_Number num;
+		if( !_ParseNumber(v, num) ) { LOCJSON_EXCEPTION("Invalid number"); out_error = true; return 0; }
+		// Clinger's fast path: both the mantissa and the power of ten are exact doubles, so one operation rounds correctly
+		static const double exact[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		if( !num.overflow && num.mantissa <= (1ull << 53) && num.exponent >= -22 && num.exponent <= 22 )
+		{
+			double d = (double)num.mantissa;
+			d = num.exponent < 0 ? d / exact[-num.exponent] : d * exact[num.exponent];
+			return num.negative ? -d : d;
+		}
+		if( num.mantissa == 0 ) { return num.negative ? -0.0 : 0.0; }
+		// Slow path: strtod is correctly rounded, but needs a terminated, narrow copy using the current locale's decimal point
+		char local[64];
+		std::string heap;
+		char* buffer = local;
+		if( num.end >= sizeof(local) ) { heap.resize(num.end+1); buffer = &heap[0]; }
+		char point = *localeconv()->decimal_point;
+		for(size_t i=0; i<num.end; ++i)
+			buffer[i] = v[i] == '.' ? point : (char)v[i];
+		buffer[num.end] = '\0';
+		return std::strtod(buffer, 0);
+	}
+	LOCJSON_FUNCTION bool AsBool(const JSONValue& v, bool& out_error)
+	{
+		if( 0==v.compare(0, 4, LOCJSON_LITERAL("true")) )  { return true; }
+		if( 0==v.compare(0, 5, LOCJSON_LITERAL("false")) ) { return false; }
+		LOCJSON_EXCEPTION("Casting non-boolean value to bool"); out_error = true; return false;
+	}
+	LOCJSON_FUNCTION bool IsNull(const JSONValue& v, bool& out_error)
+	{
+		if( v.length() < 1 ) { out_error = true; return false; }
+		return 0==v.compare(0, 4, LOCJSON_LITERAL("null"));
+	}
+	inline int _HexDigit(Char c)
+	{
+		if( c >= '0' && c <= '9' ) { return c - '0'; }
+		if( c >= 'a' && c <= 'f' ) { return c - 'a' + 10; }
+		if( c >= 'A' && c <= 'F' ) { return c - 'A' + 10; }
+		return -1;
+	}
+	inline bool _ParseHex4(const JSONValue& v, size_t i, UInt32& out)
+	{
+		if( i+4 > v.size() ) { return false; }
+		out = 0;
+		for(size_t j=i; j<i+4; ++j)
+		{
+			int d = _HexDigit(v[j]);
+			if( d < 0 ) { return false; }
+			out = out*16 + (UInt32)d;
+		}
+		return true;
+	}
+	// Writes a code point as UTF-8, UTF-16 or UTF-32 depending on the size of Char, returning the number of Chars.
+	inline size_t _EncodeCodepoint(UInt32 cp, Char* out)
+	{
+		if( sizeof(Char) == 1 )
+		{
+			if( cp < 0x80 )    { out[0] = (Char)cp; return 1; }
+			if( cp < 0x800 )   { out[0] = (Char)(0xC0 | (cp >> 6));  out[1] = (Char)(0x80 | (cp & 0x3F)); return 2; }
+			if( cp < 0x10000 ) { out[0] = (Char)(0xE0 | (cp >> 12)); out[1] = (Char)(0x80 | ((cp >> 6) & 0x3F)); out[2] = (Char)(0x80 | (cp & 0x3F)); return 3; }
+			out[0] = (Char)(0xF0 | (cp >> 18)); out[1] = (Char)(0x80 | ((cp >> 12) & 0x3F)); out[2] = (Char)(0x80 | ((cp >> 6) & 0x3F)); out[3] = (Char)(0x80 | (cp & 0x3F)); return 4;
+		}
+		if( sizeof(Char) == 2 && cp >= 0x10000 )
+		{
+			cp -= 0x10000;
+			out[0] = (Char)(0xD800 | (cp >> 10)); out[1] = (Char)(0xDC00 | (cp & 0x3FF)); return 2;
+		}
+		out[0] = (Char)cp; return 1;
+	}
+	inline size_t _Append(Char* buffer, size_t capacity, size_t length, const Char* data, size_t count)
+	{
+		if( length < capacity )
+			memcpy(buffer + length, data, (count < capacity-length ? count : capacity-length) * sizeof(Char));
+		return length + count;
+	}
+	LOCJSON_FUNCTION size_t UnescapeString(const JSONValue& v, Char* buffer, size_t capacity, bool& out_error)
+	{
+		if( v.length() < 1 || v[0] != '"' ) { LOCJSON_EXCEPTION("Casting non-string value to string"); out_error = true; return 0; }
+		size_t length = 0;
+		for(size_t i=1; ;)
+		{
+			size_t j = _FindFirstOf<'"','\\'>(v, i);
+			if( j == JSONValue::npos || (v[j] == '\\' && j+1 >= v.size()) ) { LOCJSON_EXCEPTION("Unterminated string"); out_error = true; return length; }
+			length = _Append(buffer, capacity, length, v.data()+i, j-i);//copy the run of plain characters
+			if( v[j] == '"' ) { return length; }
+			UInt32 cp = 0;
+			i = j+2;
+			switch( v[j+1] )
+			{
+			case '"': case '\\': case '/': cp = (UInt32)v[j+1]; break;
+			case 'b': cp = '\b'; break;
+			case 'f': cp = '\f'; break;
+			case 'n': cp = '\n'; break;
+			case 'r': cp = '\r'; break;
+			case 't': cp = '\t'; break;
+			case 'u':
+				if( !_ParseHex4(v, j+2, cp) ) { LOCJSON_EXCEPTION("Invalid Escape sequence"); out_error = true; cp = 0xFFFD; break; }
+				i = j+6;
+				if( cp >= 0xD800 && cp < 0xDC00 )//high surrogate, which must be followed by an escaped low surrogate
+				{
+					UInt32 low;
+					if( i+1 < v.size() && v[i] == '\\' && v[i+1] == 'u' && _ParseHex4(v, i+2, low) && low >= 0xDC00 && low < 0xE000 )
+					{
+						cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+						i += 6;
+					}
+					else
+						cp = 0xFFFD;
+				}
+				else if( cp >= 0xDC00 && cp < 0xE000 )
+					cp = 0xFFFD;
+				break;
+			default: LOCJSON_EXCEPTION("Invalid Escape sequence"); out_error = true; cp = 0xFFFD; break;
+			}
+			Char encoded[4];
+			length = _Append(buffer, capacity, length, encoded, _EncodeCodepoint(cp, encoded));
+		}
+	}
+	LOCJSON_FUNCTION StringView AsRawString(const JSONValue& v, bool& out_error)
+	{
+		if( v.length() < 1 || v[0] != '"' ) { LOCJSON_EXCEPTION("Casting non-string value to string"); out_error = true; return StringView(); }
+		size_t end = SkipString(v, 0, out_error);
+		if( end == JSONValue::npos ) { return StringView(); }
+		return v.substr(1, end-2);
+	}
+	LOCJSON_FUNCTION StringView AsStringView(const JSONValue& v, Char* buffer, size_t capacity, bool& out_error)
+	{
+		if( v.length() < 1 || v[0] != '"' ) { LOCJSON_EXCEPTION("Casting non-string value to string"); out_error = true; return StringView(); }
+		size_t end = _FindFirstOf<'"','\\'>(v, 1);
+		if( end == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated string"); out_error = true; return StringView(); }
+		if( v[end] == '"' ) { return v.substr(1, end-1); }
+		size_t length = UnescapeString(v, buffer, capacity, out_error);
+		if( length > capacity ) { LOCJSON_EXCEPTION("String buffer too small"); out_error = true; length = capacity; }
+		return StringView(buffer, length);
+	}
+	LOCJSON_FUNCTION String AsString(const JSONValue& v, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatAsString);
+		if( v.length() < 1 || v[0] != '"' ) { LOCJSON_EXCEPTION("Casting non-string value to string"); out_error = true; return String(LOCJSON_LITERAL("")); }
+		size_t end = _FindFirstOf<'"','\\'>(v, 1);
+		if( end == JSONValue::npos ) { LOCJSON_EXCEPTION("Unterminated string"); out_error = true; return String(LOCJSON_LITERAL("")); }
+		LOCJSON_STAT_ALLOCATION();
+		if( v[end] == '"' ) { return String(v.substr(1, end-1)); }
+		Char local[256];
+		size_t length = UnescapeString(v, local, 256, out_error);
+		if( length <= 256 ) { return String(StringView(local, length)); }
+		std::vector<Char> heap(length);
+		UnescapeString(v, &heap[0], length, out_error);
+		return String(StringView(&heap[0], length));
+	}
+	LOCJSON_FUNCTION JSONArray AsArray(const JSONValue& v, bool& out_error) { if(!IsArray(v, out_error)) { LOCJSON_EXCEPTION("Casting non-array value to array"); out_error = true; } return v; }
+	LOCJSON_FUNCTION bool IsArray(const JSONValue& v, bool& out_error)
+	{
+		if( v.length() < 1 ) { out_error = true; return false; }
+		return v[0] == '[';
+	}
+	LOCJSON_FUNCTION bool IsObject(const JSONValue& v, bool& out_error)
+	{
+		if( v.length() < 1 ) { out_error = true; return false; }
+		return v[0] == '{';
+	}
+
+	LOCJSON_FUNCTION int ArraySize(const JSONArray& v, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatArraySize);
+		if( v.length() < 1 || v[0] != '[' ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return 0; }
+		int count = 0;
+		for(size_t i=1; _NextElement(v, i, out_error); ++count)
+			i = _SkipOver(v, i, out_error);
+		return count;
+	}
+	LOCJSON_FUNCTION JSONValue IndexArray(const JSONArray& v, int index, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatIndexArray);
+		if( v.length() < 1 || v[0] != '[' ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return LOCJSON_LITERAL(""); }
+		int count = 0;
+		for(size_t i=1; _NextElement(v, i, out_error); ++count)
+		{
+			if( count == index )
+				return v.substr(i);
+			i = _SkipOver(v, i, out_error);
+		}
+		LOCJSON_EXCEPTION("Array index out of bounds"); 
+		out_error = true;
+		return LOCJSON_LITERAL("");
+	}
+
+	LOCJSON_FUNCTION JSONArrayIterator& JSONArrayIterator::operator++()
+	{
+		LOCJSON_STAT_SCOPE(JSONStatIterateArray);
+		size_t i = end;
+		if( !_NextElement(array, i, *out_error) ) { begin = end = JSONValue::npos; return *this; }
+		begin = i;
+		end = _SkipOver(array, i, *out_error);
+		if( end == JSONValue::npos ) { end = array.size(); }
+		return *this;
+	}
+	LOCJSON_FUNCTION JSONValue JSONArrayIterator::operator*() const { return array.substr(begin, end-begin); }
+	LOCJSON_FUNCTION JSONArrayRange IterateArray(const JSONArray& v, bool& out_error)
+	{
+		JSONArrayRange range;
+		range.first.array = v;
+		range.first.out_error = &out_error;
+		if( !IsArray(v, out_error) ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return range; }
+		range.first.end = 1;
+		++range.first;
+		return range;
+	}
+	LOCJSON_FUNCTION JSONObjectIterator& JSONObjectIterator::operator++()
+	{
+		LOCJSON_STAT_SCOPE(JSONStatIterateObject);
+		size_t i = valueEnd;
+		if( !_NextMember(object, i, keyEnd, valueBegin, *out_error) ) { keyBegin = valueEnd = JSONValue::npos; return *this; }
+		keyBegin = i;
+		valueEnd = _SkipOver(object, valueBegin, *out_error);
+		if( valueEnd == JSONValue::npos ) { valueEnd = object.size(); }
+		return *this;
+	}
+	LOCJSON_FUNCTION JSONMember JSONObjectIterator::operator*() const
+	{
+		JSONMember m = { object.substr(keyBegin+1, keyEnd-keyBegin-2), object.substr(valueBegin, valueEnd-valueBegin) };
+		return m;
+	}
+	LOCJSON_FUNCTION JSONObjectRange IterateObject(const JSONValue& v, bool& out_error)
+	{
+		JSONObjectRange range;
+		range.first.object = v;
+		range.first.out_error = &out_error;
+		if( !IsObject(v, out_error) ) { LOCJSON_EXCEPTION("Invalid object"); out_error = true; return range; }
+		range.first.valueEnd = 1;
+		++range.first;
+		return range;
+	}
+
+	// Iterative, like SkipValue. `open` holds the tape positions of the containers being filled, whose
+	// end/next are set when they close.
+	inline size_t _IndexValue(const JSONValue& v, size_t i, std::vector<JSONIndexEntry>& tape, bool& out_error)
+	{
+		_Nesting nesting;
+		std::vector<size_t> open;
+		size_t keyEnd, valueBegin;
+		for(;;)
+		{
+			size_t node = tape.size();
+			JSONIndexEntry entry = { (UInt32)i, 0, 0, 0 };
+			if( tape.size() == tape.capacity() ) { LOCJSON_STAT_ALLOCATION(); }
+			tape.push_back(entry);
+			switch( v[i] )
+			{
+			case '{': case '[':
+				if( !nesting.Push(v[i] == '{') ) { LOCJSON_EXCEPTION("Nesting too deep"); out_error = true; return JSONValue::npos; }
+				open.push_back(node);
+				++i;
+				break;
+			case '"': i = SkipString(v, i, out_error); break;
+			case 't': case 'f': case 'n': i = SkipBoolNull(v, i, out_error); break;
+			default:  i = SkipNumber(v, i, out_error); break;
+			}
+			if( out_error ) { return JSONValue::npos; }
+			if( i == JSONValue::npos ) { i = v.size(); }//a number ending the document
+			if( open.empty() || open.back() != node )//a scalar, which is complete already
+			{
+				tape[node].end = (UInt32)i;
+				tape[node].next = (UInt32)tape.size();
+			}
+			//move on to the next value, closing the containers that end first
+			for(;; ++i, --nesting.depth)
+			{
+				if( nesting.depth == 0 ) { return i; }
+				JSONIndexEntry& container = tape[open.back()];
+				bool object = nesting.InObject();
+				if( object ? _NextMember(v, i, keyEnd, valueBegin, out_error) : _NextElement(v, i, out_error) )
+				{
+					if( out_error ) { return JSONValue::npos; }
+					++container.count;
+					if( object )
+					{
+						JSONIndexEntry key = { (UInt32)i, (UInt32)keyEnd, 0, (UInt32)tape.size()+1 };
+						if( tape.size() == tape.capacity() ) { LOCJSON_STAT_ALLOCATION(); }
+						tape.push_back(key);
+						i = valueBegin;
+					}
+					break;
+				}
+				if( i == JSONValue::npos || out_error ) { out_error = true; return JSONValue::npos; }
+				container.end = (UInt32)(i+1);
+				container.next = (UInt32)tape.size();
+				open.pop_back();
+			}
+		}
+	}
+	LOCJSON_FUNCTION JSONNode Parse(const JSONValue& doc, JSONIndex& out_index, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatParseIndex);
+#if !defined(LOCJSON_NO_MMAP) && !defined(LOCJSON_WIDE)
+		CloseIndexCache(out_index);
+#endif
+		out_index.text = doc;
+		out_index.tape.clear();
+		const JSONValue& v = out_index.text;
+		size_t i = _FindFirstNotOf<' ','\t','\r','\n','\f','\b'>(v, 0);
+		if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Empty document"); out_error = true; return JSONNode(); }
+		//tape entries hold 32-bit offsets. Every entry starts at a different character, so this also bounds the tape's length.
+		if( (UInt64)v.size() > 0xFFFFFFFFu ) { LOCJSON_EXCEPTION("Document too large to index"); out_error = true; return JSONNode(); }
+		bool error = false;
+		_IndexValue(v, i, out_index.tape, error);
+		if( error ) { out_error = true; out_index.tape.clear(); return JSONNode(); }
+		return JSONNode(&out_index, 0);
+	}
+	inline const JSONIndexEntry* _Tape(const JSONIndex& index)
+	{
+		return index.cachedTape ? index.cachedTape : index.tape.empty() ? 0 : &index.tape[0];
+	}
+	inline const JSONIndexEntry* _Entry(const JSONNode& n)
+	{
+		if( !n.index ) { return 0; }
+		size_t size = n.index->cachedTape ? n.index->cachedSize : n.index->tape.size();
+		return n.node < size ? _Tape(*n.index) + n.node : 0;
+	}
+	static const UInt32 _CachedNumberBit = 0x80000000u;
+	inline const JSONIndexNumber* _CachedNumber(const JSONNode& n)
+	{
+		const JSONIndexEntry* e = _Entry(n);
+		if( !e || !n.index->cachedNumbers || !(e->count & _CachedNumberBit) ) { return 0; }
+		return n.index->cachedNumbers + (e->count & ~_CachedNumberBit);
+	}
+	LOCJSON_FUNCTION Int32 LookupInt32(const JSONNode& v, const Char* field, bool& out_error)     { return AsInt32( LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION UInt32 LookupUInt32(const JSONNode& v, const Char* field, bool& out_error)   { return AsUInt32(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION Int64 LookupInt64(const JSONNode& v, const Char* field, bool& out_error)     { return AsInt64( LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION UInt64 LookupUInt64(const JSONNode& v, const Char* field, bool& out_error)   { return AsUInt64(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION double LookupDouble(const JSONNode& v, const Char* field, bool& out_error)   { return AsDouble(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION bool LookupBool(const JSONNode& v, const Char* field, bool& out_error)       { return AsBool(  LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION String LookupString(const JSONNode& v, const Char* field, bool& out_error)   { return AsString(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION StringView LookupStringView(const JSONNode& v, const Char* field, Char* buffer, size_t capacity, bool& out_error) { return AsStringView(LookupValue(v, field, out_error), buffer, capacity, out_error); }
+	LOCJSON_FUNCTION JSONNode LookupArray(const JSONNode& v, const Char* field, bool& out_error)  { return AsArray(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION bool HasField(const JSONNode& v, const Char* field, bool& out_error)         { return 0 != _Entry(LookupValue(v, field, out_error)); }
+	LOCJSON_FUNCTION bool HasArrayField(const JSONNode& v, const Char* field, bool& out_error)    { return IsArray(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION bool HasNullField(const JSONNode& v, const Char* field, bool& out_error)     { return IsNull(LookupValue(v, field, out_error), out_error); }
+	LOCJSON_FUNCTION JSONNode LookupValue(const JSONNode& v, const Char* field, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatLookupValue);
+		if( !IsObject(v, out_error) ) { out_error = true; return JSONNode(); }
+		const JSONIndexEntry* tape = _Tape(*v.index);
+		const JSONValue& text = v.index->text;
+		size_t fieldLen = LOCJSON_STRLEN(field);
+		for(UInt32 key = v.node+1, end = tape[v.node].next; key < end; key = tape[key+1].next)
+		{
+			size_t keyLen = tape[key].end - tape[key].begin - 2;
+			if( fieldLen == keyLen && 0==text.compare(tape[key].begin+1, keyLen, field) )
+				return JSONNode(v.index, key+1);
+		}
+		return JSONNode();
+	}
+	LOCJSON_FUNCTION JSONValue AsValue(const JSONNode& v, bool& out_error)
+	{
+		const JSONIndexEntry* e = _Entry(v);
+		if( !e ) { out_error = true; return LOCJSON_LITERAL(""); }
+		return v.index->text.substr(e->begin, e->end - e->begin);
+	}
+	// Numbers decoded by an index cache are used directly; anything else (including every error) goes through the text.
+	inline UInt64 _AsInteger(const JSONNode& v, UInt64 maxPositive, UInt64 maxNegative, bool& out_negative, bool& out_error)
+	{
+		const JSONIndexNumber* n = _CachedNumber(v);
+		if( !n || !n->integer || n->magnitude > (n->negative ? maxNegative : maxPositive) )
+			return _AsInteger(AsValue(v, out_error), maxPositive, maxNegative, out_negative, out_error);
+		out_negative = n->negative != 0;
+		return n->magnitude;
+	}
+	LOCJSON_FUNCTION Int32 AsInt32(const JSONNode& v, bool& out_error)
+	{
+		bool negative = false;
+		UInt64 m = _AsInteger(v, 0x7FFFFFFFu, 0x80000000u, negative, out_error);
+		return negative ? (Int32)(0u - (UInt32)m) : (Int32)m;
+	}
+	LOCJSON_FUNCTION UInt32 AsUInt32(const JSONNode& v, bool& out_error)
+	{
+		bool negative = false;
+		return (UInt32)_AsInteger(v, 0xFFFFFFFFu, 0, negative, out_error);
+	}
+	LOCJSON_FUNCTION Int64 AsInt64(const JSONNode& v, bool& out_error)
+	{
+		bool negative = false;
+		UInt64 m = _AsInteger(v, 0x7FFFFFFFFFFFFFFFull, 0x8000000000000000ull, negative, out_error);
+		return negative ? (Int64)(0u - m) : (Int64)m;
+	}
+	LOCJSON_FUNCTION UInt64 AsUInt64(const JSONNode& v, bool& out_error)
+	{
+		bool negative = false;
+		return _AsInteger(v, ~(UInt64)0, 0, negative, out_error);
+	}
+	LOCJSON_FUNCTION double AsDouble(const JSONNode& v, bool& out_error)
+	{
+		const JSONIndexNumber* n = _CachedNumber(v);
+		return n ? n->value : AsDouble(AsValue(v, out_error), out_error);
+	}
+	LOCJSON_FUNCTION bool AsBool(const JSONNode& v, bool& out_error)      { return AsBool(  AsValue(v, out_error), out_error); }
+	LOCJSON_FUNCTION bool IsNull(const JSONNode& v, bool& out_error)      { return IsNull(  AsValue(v, out_error), out_error); }
+	LOCJSON_FUNCTION String AsString(const JSONNode& v, bool& out_error)  { return AsString(AsValue(v, out_error), out_error); }
+	LOCJSON_FUNCTION StringView AsRawString(const JSONNode& v, bool& out_error) { return AsRawString(AsValue(v, out_error), out_error); }
+	LOCJSON_FUNCTION StringView AsStringView(const JSONNode& v, Char* buffer, size_t capacity, bool& out_error) { return AsStringView(AsValue(v, out_error), buffer, capacity, out_error); }
+	LOCJSON_FUNCTION JSONNode AsArray(const JSONNode& v, bool& out_error) { if(!IsArray(v, out_error)) { LOCJSON_EXCEPTION("Casting non-array value to array"); out_error = true; } return v; }
+	LOCJSON_FUNCTION bool IsArray(const JSONNode& v, bool& out_error)
+	{
+		const JSONIndexEntry* e = _Entry(v);
+		if( !e ) { out_error = true; return false; }
+		return v.index->text[e->begin] == '[';
+	}
+	LOCJSON_FUNCTION bool IsObject(const JSONNode& v, bool& out_error)
+	{
+		const JSONIndexEntry* e = _Entry(v);
+		if( !e ) { out_error = true; return false; }
+		return v.index->text[e->begin] == '{';
+	}
+	LOCJSON_FUNCTION int ArraySize(const JSONNode& v, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatArraySize);
+		if( !IsArray(v, out_error) ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return 0; }
+		return (int)_Entry(v)->count;
+	}
+	LOCJSON_FUNCTION JSONNode IndexArray(const JSONNode& v, int index, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatIndexArray);
+		if( !IsArray(v, out_error) ) { LOCJSON_EXCEPTION("Invalid Array"); out_error = true; return JSONNode(); }
+		const JSONIndexEntry* tape = _Tape(*v.index);
+		if( index < 0 || (UInt32)index >= tape[v.node].count ) { LOCJSON_EXCEPTION("Array index out of bounds"); out_error = true; return JSONNode(); }
+		UInt32 element = v.node+1;
+		for(; index; --index)
+			element = tape[element].next;
+		return JSONNode(v.index, element);
+	}
+
+#if !defined(LOCJSON_NO_MMAP) && !defined(LOCJSON_WIDE)
+	// Index cache file layout: this header, then the tape, then the decoded numbers.
+	struct _IndexCacheHeader
+	{
+		char   magic[8];
+		UInt32 version;
+		UInt32 layout;     // byte order and record sizes, so that caches aren't shared between incompatible builds
+		UInt64 sourceSize;
+		Int64  sourceTime;
+		UInt64 sourceHash;
+		UInt64 entries;
+		UInt64 numbers;
+	};
+	static const char   _IndexCacheMagic[8] = { 'L','O','C','J','S','O','N','I' };
+	static const UInt32 _IndexCacheLayout = 0x01020000u | (UInt32)(sizeof(JSONIndexEntry) << 8) | (UInt32)sizeof(JSONIndexNumber);
+	// Eight bytes per step, to keep the hash cheap next to a full parse
+	inline UInt64 _ContentHash(const char* p, size_t n)
+	{
+		UInt64 h = 0xCBF29CE484222325ull ^ n;
+		for(size_t i=0; i<n; i += 8)
+		{
+			UInt64 word = 0;
+			memcpy(&word, p + i, n - i < 8 ? n - i : 8);
+			h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+			h ^= h >> 32;
+		}
+		return h;
+	}
+	LOCJSON_FUNCTION bool SaveIndexCache(const JSONIndex& index, const JSONMappedFile& source, const char* path, bool& out_error)
+	{
+		const JSONIndexEntry* tape = _Tape(index);
+		size_t size = index.cachedTape ? index.cachedSize : index.tape.size();
+		if( !size || index.text.data() != source.data || index.text.size() != source.size ) { LOCJSON_EXCEPTION("Index is not of the source file"); out_error = true; return false; }
+		std::vector<JSONIndexEntry> entries(tape, tape + size);
+		std::vector<JSONIndexNumber> numbers;
+		for(size_t e=0; e<size; ++e)
+		{
+			Char c = index.text[entries[e].begin];
+			if( c != '-' && (c < '0' || c > '9') ) { continue; }
+			JSONValue text = index.text.substr(entries[e].begin, entries[e].end - entries[e].begin);
+			_Number num;
+			if( !_ParseNumber(text, num) ) { continue; }
+			bool error = false;
+			JSONIndexNumber n = { num.mantissa, AsDouble(text, error), num.integer && !num.overflow, num.negative };
+			entries[e].count = _CachedNumberBit | (UInt32)numbers.size();
+			numbers.push_back(n);
+		}
+		_IndexCacheHeader header;
+		memcpy(header.magic, _IndexCacheMagic, sizeof(header.magic));
+		header.version    = 1;
+		header.layout     = _IndexCacheLayout;
+		header.sourceSize = source.size;
+		header.sourceTime = source.modified;
+		header.sourceHash = _ContentHash(source.data, source.size);
+		header.entries    = entries.size();
+		header.numbers    = numbers.size();
+		// Written to a temporary file and renamed, so that a reader never maps a partial cache
+		std::vector<char> temp(path, path + strlen(path));
+		temp.insert(temp.end(), ".tmp", ".tmp" + 5);
+		FILE* file = fopen(&temp[0], "wb");
+		if( !file ) { LOCJSON_EXCEPTION("Could not create index cache"); out_error = true; return false; }
+		bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		               fwrite(&entries[0], sizeof(JSONIndexEntry), entries.size(), file) == entries.size() &&
+		               (numbers.empty() || fwrite(&numbers[0], sizeof(JSONIndexNumber), numbers.size(), file) == numbers.size());
+		written = (fclose(file) == 0) && written;
+# if defined(_WIN32)
+		if( written ) { remove(path); }
+# endif
+		if( !written || rename(&temp[0], path) != 0 ) { remove(&temp[0]); LOCJSON_EXCEPTION("Could not write index cache"); out_error = true; return false; }
+		return true;
+	}
+	// The cache file may be corrupt or truncated in ways the header can't show, so check everything that
+	// lookups will follow. Walking the tape in order with a stack of open containers, as _IndexValue built
+	// it: every value is a slice of the source starting on a character, scalars and keys own no subtree,
+	// each child's subtree ends inside its parent, every key is followed by its value, containers hold
+	// `count` children, and number slots are in range.
+	inline bool _ValidCacheTape(const JSONIndexEntry* tape, UInt64 entries, UInt64 numbers, const char* text, UInt64 sourceSize)
+	{
+		struct Open { UInt64 node, next, children; bool object; };
+		std::vector<Open> open;
+		if( tape[0].next != entries ) { return false; }
+		for(UInt64 k=0; k<=entries; ++k)
+		{
+			while( !open.empty() && open.back().next == k )
+			{
+				const Open& c = open.back();
+				if( c.object ? (c.children & 1) || tape[c.node].count != c.children/2 : tape[c.node].count != c.children ) { return false; }
+				open.pop_back();
+			}
+			if( k == entries ) { break; }
+			const JSONIndexEntry& e = tape[k];
+			if( e.begin >= e.end || e.end > sourceSize || e.next <= k || e.next > entries ) { return false; }
+			if( (e.count & _CachedNumberBit) && (e.count & ~_CachedNumberBit) >= numbers ) { return false; }
+			bool key = !open.empty() && open.back().object && !(open.back().children & 1);
+			if( !open.empty() )
+			{
+				if( e.next > open.back().next ) { return false; }
+				++open.back().children;
+			}
+			else if( k != 0 ) { return false; }
+			if( key && (text[e.begin] != '"' || e.end - e.begin < 2) ) { return false; }
+			if( !key && (text[e.begin] == '{' || text[e.begin] == '[') )
+			{
+				Open c = { k, e.next, 0, text[e.begin] == '{' };
+				open.push_back(c);
+			}
+			else if( e.next != k+1 ) { return false; }
+		}
+		return true;
+	}
+	LOCJSON_FUNCTION JSONNode LoadIndexCache(JSONIndex& out_index, const JSONMappedFile& source, const char* path, bool checkHash, bool& out_error)
+	{
+		CloseIndexCache(out_index);
+		out_index.tape.clear();
+		out_index.text = Parse(source);
+		FILE* exists = fopen(path, "rb");
+		if( !exists ) { return JSONNode(); }//no cache yet
+		fclose(exists);
+		JSONMappedFile cache;
+		if( !OpenMappedFile(path, cache, out_error) ) { return JSONNode(); }
+		_IndexCacheHeader header;
+		bool valid = cache.size >= sizeof(header);
+		if( valid )
+		{
+			memcpy(&header, cache.data, sizeof(header));
+			valid = 0 == memcmp(header.magic, _IndexCacheMagic, sizeof(header.magic)) && header.version == 1 && header.layout == _IndexCacheLayout &&
+			        header.sourceSize == source.size && header.sourceTime == source.modified && header.entries > 0 && header.entries <= 0xFFFFFFFFu &&
+			        header.numbers <= header.entries && cache.size == sizeof(header) + header.entries * sizeof(JSONIndexEntry) + header.numbers * sizeof(JSONIndexNumber) &&
+			        (!checkHash || header.sourceHash == _ContentHash(source.data, source.size)) &&
+			        _ValidCacheTape((const JSONIndexEntry*)(cache.data + sizeof(header)), header.entries, header.numbers, source.data, header.sourceSize);
+		}
+		if( !valid ) { CloseMappedFile(cache); return JSONNode(); }//stale, or written by an incompatible build
+		out_index.cache = cache;
+		out_index.cachedTape = (const JSONIndexEntry*)(cache.data + sizeof(header));
+		out_index.cachedNumbers = (const JSONIndexNumber*)(cache.data + sizeof(header) + header.entries * sizeof(JSONIndexEntry));
+		out_index.cachedSize = (UInt32)header.entries;
+		return JSONNode(&out_index, 0);
+	}
+	LOCJSON_FUNCTION void CloseIndexCache(JSONIndex& index)
+	{
+		CloseMappedFile(index.cache);
+		index.cachedTape = 0;
+		index.cachedNumbers = 0;
+		index.cachedSize = 0;
+	}
+#endif
+#if defined(LOCJSON_WIDE_UTF8)
+	// Decodes one multi-byte sequence at p[i], returning U+FFFD (and consuming one byte) if it is invalid
+	inline UInt32 _DecodeUTF8(const char* p, size_t& i, size_t n)
+	{
+		UInt32 c = (unsigned char)p[i], cp, minimum;
+		size_t length;
+		if(      (c & 0xE0) == 0xC0 ) { length = 2; cp = c & 0x1F; minimum = 0x80; }
+		else if( (c & 0xF0) == 0xE0 ) { length = 3; cp = c & 0x0F; minimum = 0x800; }
+		else if( (c & 0xF8) == 0xF0 ) { length = 4; cp = c & 0x07; minimum = 0x10000; }
+		else { ++i; return 0xFFFD; }
+		if( n - i < length ) { ++i; return 0xFFFD; }
+		for(size_t k=1; k<length; ++k)
+		{
+			UInt32 b = (unsigned char)p[i+k];
+			if( (b & 0xC0) != 0x80 ) { ++i; return 0xFFFD; }
+			cp = (cp << 6) | (b & 0x3F);
+		}
+		if( cp < minimum || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000) ) { ++i; return 0xFFFD; }
+		i += length;
+		return cp;
+	}
+	// UTF-8 never takes fewer bytes than the UTF-16/32 units that it becomes, so `out` is sized once up front.
+	LOCJSON_FUNCTION void TranscodeUTF8(const char* p, size_t n, WideString& out)
+	{
+		out.resize(n);
+		if( !n ) { return; }
+		wchar_t* o = &out[0];
+		size_t i = 0, w = 0;
+		while( i < n )
+		{
+#if defined(LOCJSON_SSE2)
+			//widen runs of ASCII 16 characters at a time
+			for(; i + 16 <= n; i += 16, w += 16)
+			{
+				__m128i x = _mm_loadu_si128((const __m128i*)(p+i));
+				unsigned mask = (unsigned)_mm_movemask_epi8(x);
+				if( mask ) { unsigned ascii = _TrailingZeros(mask); for(unsigned k=0; k<ascii; ++k) { o[w++] = (wchar_t)p[i++]; } break; }
+				const __m128i zero = _mm_setzero_si128();
+				__m128i lo = _mm_unpacklo_epi8(x, zero), hi = _mm_unpackhi_epi8(x, zero);
+				if( sizeof(wchar_t) == 2 )
+				{
+					_mm_storeu_si128((__m128i*)(o+w), lo);
+					_mm_storeu_si128((__m128i*)(o+w+8), hi);
+				}
+				else
+				{
+					_mm_storeu_si128((__m128i*)(o+w),    _mm_unpacklo_epi16(lo, zero));
+					_mm_storeu_si128((__m128i*)(o+w+4),  _mm_unpackhi_epi16(lo, zero));
+					_mm_storeu_si128((__m128i*)(o+w+8),  _mm_unpacklo_epi16(hi, zero));
+					_mm_storeu_si128((__m128i*)(o+w+12), _mm_unpackhi_epi16(hi, zero));
+				}
+			}
+			if( i == n ) { break; }
+#endif
+			if( (unsigned char)p[i] < 0x80 ) { o[w++] = (wchar_t)p[i++]; continue; }
+			UInt32 cp = _DecodeUTF8(p, i, n);
+			if( sizeof(wchar_t) == 2 && cp >= 0x10000 )
+			{
+				cp -= 0x10000;
+				o[w++] = (wchar_t)(0xD800 | (cp >> 10));
+				o[w++] = (wchar_t)(0xDC00 | (cp & 0x3FF));
+			}
+			else
+				o[w++] = (wchar_t)cp;
+		}
+		out.resize(w);
+	}
+	LOCJSON_FUNCTION WideString AsWideString(const JSONValue& v, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatAsString);
+		WideString out;
+		StringView raw = AsRawString(v, out_error);
+		LOCJSON_STAT_ALLOCATION();
+		if( raw.find('\\') == StringView::npos ) { TranscodeUTF8(raw.data(), raw.size(), out); return out; }
+		String decoded = AsString(v, out_error);
+		TranscodeUTF8(decoded.data(), decoded.size(), out);
+		return out;
+	}
+	LOCJSON_FUNCTION WideString AsWideString(const JSONNode& v, bool& out_error) { return AsWideString(AsValue(v, out_error), out_error); }
+	LOCJSON_FUNCTION const char* _KeyToUTF8(const wchar_t* key, char* local, size_t capacity, std::vector<char>& heap)
+	{
+		size_t n = wcslen(key);
+		char* o = local;
+		if( n*4 + 1 > capacity ) { heap.resize(n*4 + 1); o = &heap[0]; }
+		const char* begin = o;
+		for(size_t i=0; i<n; ++i)
+		{
+			UInt32 cp = (UInt32)key[i];
+			if( cp < 0x80 ) { *o++ = (char)cp; continue; }
+			if( sizeof(wchar_t) == 2 && cp >= 0xD800 && cp < 0xDC00 && i+1 < n && (UInt32)key[i+1] >= 0xDC00 && (UInt32)key[i+1] < 0xE000 )
+				cp = 0x10000 + ((cp - 0xD800) << 10) + ((UInt32)key[++i] - 0xDC00);
+			else if( (cp >= 0xD800 && cp < 0xE000) || cp > 0x10FFFF )
+				cp = 0xFFFD;
+			o += _EncodeCodepoint(cp, o);
+		}
+		*o = '\0';
+		return begin;
+	}
+#endif
+
+	inline UInt32 _HashKeyRuntime(const Char* s, size_t n)
+	{
+		UInt32 h = 2166136261u;
+		for(size_t i=0; i<n; ++i)
+			h = (h ^ (UInt32)s[i]) * 16777619u;
+		return h;
+	}
+	LOCJSON_FUNCTION JSONBindTable _BuildBindTable(const JSONBoundField* fields, int count)
+	{
+		// Find a multiplicative hash that maps every bound key to its own slot. Keys with equal hashes
+		// can never be separated, and the search gives up at 4096 slots; either way, match linearly.
+		JSONBindTable table;
+		table.multiplier = 0;
+		table.shift = 32;
+		table.linear = true;
+		for(int a=0; a<count; ++a)
+			for(int b=a+1; b<count; ++b)
+				if( fields[a].hash == fields[b].hash )
+					return table;
+		table.linear = false;
+		UInt32 bits = 1;
+		while( (1 << bits) < count*2 )
+			++bits;
+		for(UInt32 seed = 0x9E3779B1u; bits <= 12; ++bits)
+		{
+			table.shift = 32 - bits;
+			for(int attempt = 0; attempt < 256; ++attempt, seed = seed * 1664525u + 1013904223u)
+			{
+				table.multiplier = seed | 1;
+				table.slots.assign((size_t)1 << bits, 0);
+				int f = 0;
+				for(; f<count; ++f)
+				{
+					unsigned char& slot = table.slots[(UInt32)(fields[f].hash * table.multiplier) >> table.shift];
+					if( slot ) { break; }
+					slot = (unsigned char)(f+1);
+				}
+				if( f == count ) { return table; }
+			}
+		}
+		table.slots.clear();
+		table.linear = true;
+		return table;
+	}
+	LOCJSON_FUNCTION bool _DecodeObject(const JSONValue& v, void* object, const JSONBoundField* fields, int count, const JSONBindTable& table, bool& out_error, JSONBindReport* out_report, size_t* out_end)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatDecodeObject);
+		JSONBindReport report = { 0, 0, 0, 0, StringView() };
+		unsigned long long seen = 0;
+		size_t keyEnd, valueBegin;
+		size_t i = 1;
+		if( v.length() < 1 || v[0] != '{' ) { LOCJSON_EXCEPTION("Decoding non-object value"); out_error = true; count = 0; i = JSONValue::npos; }
+		while( count && _NextMember(v, i, keyEnd, valueBegin, out_error) )
+		{
+			const Char* key = &v[i+1];
+			size_t keyLen = keyEnd-i-2;
+			int f = -1;
+			if( !table.linear )
+				f = table.slots[(UInt32)(_HashKeyRuntime(key, keyLen) * table.multiplier) >> table.shift] - 1;
+			else
+				for(f=0; f<count && (fields[f].length != keyLen || 0!=memcmp(fields[f].name, key, keyLen*sizeof(Char))); ++f) {}
+			if( f < 0 || f == count || fields[f].length != keyLen || 0!=memcmp(fields[f].name, key, keyLen*sizeof(Char)) )
+			{
+				if( !report.unknown++ ) { report.firstUnknown = v.substr(i+1, keyLen); }
+				i = _SkipOver(v, valueBegin, out_error);
+				continue;
+			}
+			// The decoder reports where the value ended, so it isn't skipped over a second time
+			size_t end = fields[f].decode(v.substr(valueBegin), object, out_error);
+			i = end == JSONValue::npos ? end : valueBegin + end;
+			seen |= 1ull << f;
+		}
+		if( out_end ) { *out_end = i == JSONValue::npos ? i : i+1; }
+		for(int f=0; f<count; ++f)
+		{
+			if( seen & (1ull << f) ) { ++report.found; continue; }
+			if( !report.missing++ ) { report.firstMissing = fields[f].name; }
+		}
+		if( out_report ) { *out_report = report; }
+		return count && !report.missing;
+	}
+
+	inline Char* _OtherHalf(JSONBuilder& b) { return b.data == &b.storage[0] ? b.data + b.capacity : &b.storage[0]; }
+	// Sends the pending half, then `count` characters at `s`, then `extraCount` at `extra`
+	inline bool _StreamSend(JSONBuilder& b, const Char* s, size_t count, const Char* extra = 0, size_t extraCount = 0)
+	{
+		StringView parts[3];
+		int n = 0;
+		if( b.pending ) { parts[n++] = StringView(_OtherHalf(b), b.pending); }
+		if( count )     { parts[n++] = StringView(s, count); }
+		if( extraCount ) { parts[n++] = StringView(extra, extraCount); }
+		b.pending = 0;
+		if( n && !b.sink(b.sinkUser, parts, n) )
+		{
+			if( !b.error ) { LOCJSON_EXCEPTION("JSONBuilder stream write failed"); }
+			b.error = true;
+			return false;
+		}
+		return true;
+	}
+	// Makes room in a streaming builder. The finished values in this half are either left pending while the
+	// other half is filled, or sent along with the pending half; the value in progress moves to the half that
+	// is written next, so that NDJSON lines stay whole.
+	inline bool _StreamReserve(JSONBuilder& b, size_t count)
+	{
+		if( b.error ) { return false; }
+		size_t complete = b.record ? b.record : b.size;
+		size_t partial = b.size - complete;
+		if( b.pending )
+		{
+			if( !_StreamSend(b, b.data, complete) ) { return false; }
+			memmove(b.data, b.data + complete, partial*sizeof(Char));
+		}
+		else
+		{
+			Char* other = _OtherHalf(b);
+			memcpy(other, b.data + complete, partial*sizeof(Char));
+			b.pending = complete;
+			b.data = other;
+		}
+		b.size = partial;
+		b.record = 0;
+		if( b.size + count <= b.capacity ) { return true; }
+		if( !_StreamSend(b, b.data, b.size) ) { return false; }//a value longer than half the buffer
+		b.size = 0;
+		return count <= b.capacity;
+	}
+	inline bool _Reserve(JSONBuilder& b, size_t count)
+	{
+		size_t needed = b.size + count;
+		if( needed <= b.capacity && !(b.fixed & b.error) ) { return true; }//once a fixed buffer has overflowed, drop all further writes rather than emitting fragments that happen to fit
+		if( b.sink ) { return _StreamReserve(b, count); }
+		if( b.fixed )
+		{
+			if( !b.error ) { LOCJSON_EXCEPTION("JSONBuilder buffer overflow"); }
+			b.error = true;
+			return false;
+		}
+		size_t capacity = b.capacity ? b.capacity*2 : 256;
+		while( capacity < needed )
+			capacity *= 2;
+		LOCJSON_STAT_ALLOCATION();
+		b.storage.resize(capacity);
+		b.data = &b.storage[0];
+		b.capacity = capacity;
+		return true;
+	}
+	inline void _Write(JSONBuilder& b, const Char* s, size_t count)
+	{
+		if( b.sink && count > b.capacity )
+		{
+			if( !b.error && _StreamSend(b, b.data, b.size, s, count) ) { b.size = b.record = 0; }
+			return;
+		}
+		if( !_Reserve(b, count) ) { return; }
+		memcpy(b.data + b.size, s, count*sizeof(Char));
+		b.size += count;
+	}
+	inline void _WriteASCII(JSONBuilder& b, const char* s, size_t count)
+	{
+		if( !_Reserve(b, count) ) { return; }
+		for(size_t i=0; i<count; ++i)
+			b.data[b.size++] = (Char)s[i];
+	}
+	inline void _Put(JSONBuilder& b, Char c)
+	{
+		if( _Reserve(b, 1) ) { b.data[b.size++] = c; }
+	}
+	// Returns the end of the run of characters starting at `i` that can be copied without escaping
+	inline size_t _PlainRun(const Char* s, size_t i, size_t n)
+	{
+#if defined(LOCJSON_SSE2)
+		if( sizeof(Char) == 1 )
+		{
+			const __m128i quote = _mm_set1_epi8('"'), slash = _mm_set1_epi8('\\'), control = _mm_set1_epi8(0x1F);
+			for(; i+16 <= n; i += 16)
+			{
+				__m128i x = _mm_loadu_si128((const __m128i*)(s+i));
+				__m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, slash)), _mm_cmpeq_epi8(_mm_min_epu8(x, control), x));
+				unsigned mask = (unsigned)_mm_movemask_epi8(special);
+				if( mask ) { return i + _TrailingZeros(mask); }
+			}
+		}
+#endif
+		for(; i<n; ++i)
+			if( s[i] == '"' || s[i] == '\\' || (UInt32)s[i] < 0x20 ) { break; }
+		return i;
+	}
+	inline void _WriteString(JSONBuilder& b, const Char* s, size_t n)
+	{
+		_Put(b, '"');
+		for(size_t i=0; ; ++i)
+		{
+			size_t end = _PlainRun(s, i, n);
+			_Write(b, s+i, end-i);
+			if( end == n ) { break; }
+			i = end;
+			switch( s[i] )
+			{
+			case '"':  _WriteASCII(b, "\\\"", 2); break;
+			case '\\': _WriteASCII(b, "\\\\", 2); break;
+			case '\b': _WriteASCII(b, "\\b", 2); break;
+			case '\f': _WriteASCII(b, "\\f", 2); break;
+			case '\n': _WriteASCII(b, "\\n", 2); break;
+			case '\r': _WriteASCII(b, "\\r", 2); break;
+			case '\t': _WriteASCII(b, "\\t", 2); break;
+			default:
+				{
+					char escape[7] = { '\\', 'u', '0', '0', "0123456789abcdef"[(s[i] >> 4) & 0xF], "0123456789abcdef"[s[i] & 0xF], 0 };
+					_WriteASCII(b, escape, 6);
+				}
+			}
+		}
+		_Put(b, '"');
+	}
+	inline void _WriteUInt(JSONBuilder& b, UInt64 value, bool negative)
+	{
+		static const char pairs[] =
+			"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+			"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+			"8081828384858687888990919293949596979899";
+		char buffer[24];
+		char* p = buffer + sizeof(buffer);
+		for(; value >= 100; value /= 100)
+		{
+			p -= 2;
+			memcpy(p, pairs + (value % 100) * 2, 2);
+		}
+		if( value >= 10 ) { p -= 2; memcpy(p, pairs + value * 2, 2); }
+		else              { *--p = (char)('0' + value); }
+		if( negative )    { *--p = '-'; }
+		_WriteASCII(b, p, (size_t)(buffer + sizeof(buffer) - p));
+	}
+	inline void _WriteInt(JSONBuilder& b, Int64 value)
+	{
+		_WriteUInt(b, value < 0 ? 0u - (UInt64)value : (UInt64)value, value < 0);
+	}
+	inline void _WriteDouble(JSONBuilder& b, double value)
+	{
+		if( !std::isfinite(value) ) { _WriteASCII(b, "null", 4); return; }//JSON has no NaN or infinity
+		char buffer[32];
+#if defined(__cpp_lib_to_chars)
+		size_t length = (size_t)(std::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer);
+#else
+		size_t length = (size_t)snprintf(buffer, sizeof(buffer), "%.17g", value);
+		char point = *localeconv()->decimal_point;
+		for(size_t i=0; i<length; ++i)
+			if( buffer[i] == point ) { buffer[i] = '.'; }
+#endif
+		_WriteASCII(b, buffer, length);
+	}
+	inline void _Separator(JSONBuilder& b)
+	{
+		UInt64 bit = (UInt64)1 << b.depth;
+		if( b.first & bit ) { b.first &= ~bit; }
+		else if( b.depth )  { _Put(b, ','); }
+		else if( b.ndjson ) { _Put(b, '\n'); }
+		if( !b.depth )      { b.record = b.size; }
+	}
+	inline void _WriteKey(JSONBuilder& b, const Char* key)
+	{
+		_Separator(b);
+		_WriteString(b, key, LOCJSON_STRLEN(key));
+		_Put(b, ':');
+	}
+	inline void _Open(JSONBuilder& b, Char c)
+	{
+		_Put(b, c);
+		if( b.depth == 63 ) { LOCJSON_EXCEPTION("JSONBuilder nesting too deep"); b.error = true; return; }
+		++b.depth;
+		b.first |= (UInt64)1 << b.depth;
+	}
+	inline void _Close(JSONBuilder& b, Char c)
+	{
+		_Put(b, c);
+		if( b.depth > 0 ) { --b.depth; }
+	}
+	LOCJSON_FUNCTION void Reset(JSONBuilder& b)
+	{
+		b.size = 0;
+		b.depth = 0;
+		b.first = 1;
+		b.error = false;
+		b.pending = 0;
+		b.record = 0;
+	}
+	LOCJSON_FUNCTION JSONValue BuilderOutput(const JSONBuilder& b) { return b.size ? JSONValue(b.data, b.size) : JSONValue(); }
+	LOCJSON_FUNCTION void OpenOutputStream(JSONBuilder& b, JSONSink sink, void* user, bool ndjson, size_t bufferSize)
+	{
+		size_t half = bufferSize / 2 < 64 ? 64 : bufferSize / 2;
+		LOCJSON_STAT_ALLOCATION();
+		b.storage.assign(half * 2, Char());
+		b.data = &b.storage[0];
+		b.capacity = half;
+		b.fixed = true;
+		b.ndjson = ndjson;
+		b.sink = sink;
+		b.sinkUser = user;
+		Reset(b);
+	}
+#if !defined(LOCJSON_WIDE)
+	LOCJSON_FUNCTION bool _WriteFD(void* user, const StringView* parts, int count)
+	{
+		int fd = (int)(size_t)user;
+	# if defined(_WIN32)
+		for(int i=0; i<count; ++i)
+			for(size_t done = 0; done < parts[i].size();)
+			{
+				unsigned chunk = parts[i].size() - done > (1u<<30) ? (1u<<30) : (unsigned)(parts[i].size() - done);
+				int written = _write(fd, parts[i].data() + done, chunk);
+				if( written <= 0 ) { return false; }
+				done += (size_t)written;
+			}
+		return true;
+	# else
+		struct iovec vectors[3];
+		for(int i=0; i<count; ++i)
+		{
+			vectors[i].iov_base = (void*)parts[i].data();
+			vectors[i].iov_len = parts[i].size();
+		}
+		for(struct iovec* v = vectors; count;)
+		{
+			ssize_t written = writev(fd, v, count);
+			if( written < 0 && errno == EINTR ) { continue; }
+			if( written <= 0 ) { return false; }
+			for(; count && (size_t)written >= v->iov_len; --count, ++v)//skip the parts that were written, then resume partway through the next
+				written -= (ssize_t)v->iov_len;
+			if( count ) { v->iov_base = (char*)v->iov_base + written; v->iov_len -= (size_t)written; }
+		}
+		return true;
+	# endif
+	}
+	LOCJSON_FUNCTION void OpenOutputStream(JSONBuilder& b, int fd, bool ndjson, size_t bufferSize) { OpenOutputStream(b, &_WriteFD, (void*)(size_t)fd, ndjson, bufferSize); }
+#endif
+	LOCJSON_FUNCTION bool FlushOutputStream(JSONBuilder& b)
+	{
+		if( !b.sink || b.error ) { return false; }
+		if( !_StreamSend(b, b.data, b.size) ) { return false; }
+		b.size = b.record = 0;
+		return true;
+	}
+	LOCJSON_FUNCTION bool CloseOutputStream(JSONBuilder& b)
+	{
+		if( !b.sink ) { return false; }
+		if( b.ndjson && !(b.first & 1) ) { _Put(b, '\n'); }//end the last line
+		bool ok = FlushOutputStream(b);
+		b.sink = 0;
+		b.sinkUser = 0;
+		b.storage = std::vector<Char>();
+		b.data = 0;
+		b.capacity = 0;
+		b.fixed = false;
+		Reset(b);
+		return ok;
+	}
+	LOCJSON_FUNCTION void BeginObject(JSONBuilder& b)                                   { _Separator(b); _Open(b, '{'); }
+	LOCJSON_FUNCTION void BeginObject(JSONBuilder& b, const Char* key)                  { _WriteKey(b, key); _Open(b, '{'); }
+	LOCJSON_FUNCTION void EndObject(JSONBuilder& b)                                     { _Close(b, '}'); }
+	LOCJSON_FUNCTION void BeginArray(JSONBuilder& b)                                    { _Separator(b); _Open(b, '['); }
+	LOCJSON_FUNCTION void BeginArray(JSONBuilder& b, const Char* key)                   { _WriteKey(b, key); _Open(b, '['); }
+	LOCJSON_FUNCTION void EndArray(JSONBuilder& b)                                      { _Close(b, ']'); }
+	LOCJSON_FUNCTION void AddString(JSONBuilder& b, const Char* key, const Char* value) { _WriteKey(b, key); _WriteString(b, value, LOCJSON_STRLEN(value)); }
+	LOCJSON_FUNCTION void AddInt32(JSONBuilder& b, const Char* key, Int32 value)        { _WriteKey(b, key); _WriteInt(b, value); }
+	LOCJSON_FUNCTION void AddUInt32(JSONBuilder& b, const Char* key, UInt32 value)      { _WriteKey(b, key); _WriteUInt(b, value, false); }
+	LOCJSON_FUNCTION void AddInt64(JSONBuilder& b, const Char* key, Int64 value)        { _WriteKey(b, key); _WriteInt(b, value); }
+	LOCJSON_FUNCTION void AddUInt64(JSONBuilder& b, const Char* key, UInt64 value)      { _WriteKey(b, key); _WriteUInt(b, value, false); }
+	LOCJSON_FUNCTION void AddDouble(JSONBuilder& b, const Char* key, double value)      { _WriteKey(b, key); _WriteDouble(b, value); }
+	LOCJSON_FUNCTION void AddBool(JSONBuilder& b, const Char* key, bool value)          { _WriteKey(b, key); _WriteASCII(b, value ? "true" : "false", value ? 4 : 5); }
+	LOCJSON_FUNCTION void AddNull(JSONBuilder& b, const Char* key)                      { _WriteKey(b, key); _WriteASCII(b, "null", 4); }
+	LOCJSON_FUNCTION void AddValue(JSONBuilder& b, const Char* value)                   { _Separator(b); _WriteString(b, value, LOCJSON_STRLEN(value)); }
+	LOCJSON_FUNCTION void AddValue(JSONBuilder& b, Int32 value)                         { _Separator(b); _WriteInt(b, value); }
+	LOCJSON_FUNCTION void AddValue(JSONBuilder& b, UInt32 value)                        { _Separator(b); _WriteUInt(b, value, false); }
+	LOCJSON_FUNCTION void AddValue(JSONBuilder& b, Int64 value)                         { _Separator(b); _WriteInt(b, value); }
+	LOCJSON_FUNCTION void AddValue(JSONBuilder& b, UInt64 value)                        { _Separator(b); _WriteUInt(b, value, false); }
+	LOCJSON_FUNCTION void AddValue(JSONBuilder& b, double value)                        { _Separator(b); _WriteDouble(b, value); }
+	LOCJSON_FUNCTION void AddValue(JSONBuilder& b, bool value)                          { _Separator(b); _WriteASCII(b, value ? "true" : "false", value ? 4 : 5); }
+	LOCJSON_FUNCTION void AddNull(JSONBuilder& b)                                       { _Separator(b); _WriteASCII(b, "null", 4); }
+
+	inline bool _IsWhitespace(Char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\b'; }
+	inline size_t _MinifyScalar(const Char* p, size_t i, size_t end, Char* out, size_t o, bool& inString, bool& escaped)
+	{
+		for(; i<end; ++i)
+		{
+			Char c = p[i];
+			if( escaped )            { escaped = false; }
+			else if( inString )      { escaped = c == '\\'; inString = c != '"'; }
+			else if( c == '"' )      { inString = true; }
+			else if( _IsWhitespace(c) ) { continue; }
+			out[o++] = c;
+		}
+		return o;
+	}
+#if defined(LOCJSON_AVX2)
+	// Shuffles that move the set bits of each 8-bit mask to the front
+	struct _CompactTable
+	{
+		_CompactTable()
+		{
+			for(unsigned m=0; m<256; ++m)
+			{
+				unsigned char* s = shuffle[m];
+				count[m] = 0;
+				for(unsigned b=0; b<8; ++b)
+					if( m & (1u << b) ) { s[count[m]++] = (unsigned char)b; }
+				for(unsigned k=count[m]; k<8; ++k)
+					s[k] = 0x80;
+			}
+		}
+		unsigned char shuffle[256][8];
+		unsigned char count[256];
+	};
+	// Packs the characters of `x` that are set in `keep` to out+o, possibly writing (but not counting) up to 16 characters
+	LOCJSON_TARGET_AVX2 inline size_t _CompactSSSE3(__m128i x, unsigned keep, Char* out, size_t o, const _CompactTable& t)
+	{
+		unsigned lo = keep & 0xFF, hi = keep >> 8;
+		long long loShuffle, hiShuffle;
+		memcpy(&loShuffle, t.shuffle[lo], 8);
+		memcpy(&hiShuffle, t.shuffle[hi], 8);
+		__m128i packed = _mm_shuffle_epi8(x, _mm_set_epi64x(hiShuffle + 0x0808080808080808ll, loShuffle));//the high half picks from bytes 8-15; 0x80 + 8 still zeroes
+		_mm_storel_epi64((__m128i*)(out+o), packed);
+		_mm_storel_epi64((__m128i*)(out+o+t.count[lo]), _mm_unpackhi_epi64(packed, packed));
+		return o + t.count[lo] + t.count[hi];
+	}
+#endif
+	// Works on 16 characters at a time: the quotes give which characters are inside strings (by a prefix XOR),
+	// and the whitespace outside of them is dropped. Blocks containing a backslash are done one character at a time.
+	LOCJSON_FUNCTION size_t Minify(const JSONValue& v, Char* out, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatMinify);
+		const Char* p = v.data();
+		size_t n = v.size(), i = 0, o = 0;
+		bool inString = false, escaped = false;
+#if defined(LOCJSON_SSE2)
+		if( sizeof(Char) == 1 )
+		{
+	# if defined(LOCJSON_AVX2)
+			static const bool avx2 = _HasAVX2();
+			static const _CompactTable* table = avx2 ? new _CompactTable() : 0;//never freed, like the stats registry
+	# endif
+			for(; i+16 <= n; i += 16)
+			{
+				__m128i x = _mm_loadu_si128((const __m128i*)(p+i));
+				if( escaped || _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('\\'))) ) { o = _MinifyScalar(p, i, i+16, out, o, inString, escaped); continue; }
+				unsigned inside = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')));
+				inside ^= inside << 1; inside ^= inside << 2; inside ^= inside << 4; inside ^= inside << 8;
+				inside = (inside ^ (inString ? 0xFFFFu : 0u)) & 0xFFFF;
+				inString = (inside >> 15) != 0;
+				unsigned keep = ~((unsigned)_mm_movemask_epi8(_MatchSSE2(x, ' ', '\t', '\r', '\n', '\f', '\b')) & ~inside) & 0xFFFF;
+				if( keep == 0xFFFF ) { _mm_storeu_si128((__m128i*)(out+o), x); o += 16; continue; }//out+o is never past p+i, so this only overwrites input already read
+	# if defined(LOCJSON_AVX2)
+				if( avx2 ) { o = _CompactSSSE3(x, keep, out, o, *table); continue; }
+	# endif
+				for(; keep; keep &= keep - 1)
+					out[o++] = p[i + _TrailingZeros(keep)];
+			}
+		}
+#endif
+		o = _MinifyScalar(p, i, n, out, o, inString, escaped);
+		if( inString ) { LOCJSON_EXCEPTION("Unterminated String"); out_error = true; }
+		return o;
+	}
+	LOCJSON_FUNCTION void Minify(JSONDocument& doc, bool& out_error)
+	{
+		if( doc.empty() ) { return; }
+		doc.resize(Minify(JSONValue(doc), &doc[0], out_error));
+	}
+
+	// ApplyEdits. Every edit becomes a range of the document that is replaced by an optional
+	// `head` (a separator and key, held in a builder) followed by `text`.
+	struct _EditRange
+	{
+		size_t    begin, end;
+		size_t    head, headLength;
+		JSONValue text;
+	};
+	struct _EditChild
+	{
+		size_t begin, end; // the member (from its key) or element
+		size_t keyEnd;
+		bool   removed;
+	};
+	// A container that members are removed from or added to, walked once to find its children
+	struct _EditContainer
+	{
+		size_t begin, end;
+		std::vector<_EditChild> children;
+		size_t kept;
+	};
+	inline _EditContainer* _EditWalk(std::vector<_EditContainer>& containers, const JSONValue& v, size_t begin, size_t end, bool& out_error)
+	{
+		for(size_t c=0; c<containers.size(); ++c)
+			if( containers[c].begin == begin ) { return &containers[c]; }
+		_EditContainer container;
+		container.begin = begin;
+		container.end = end;
+		size_t i = begin+1, keyEnd, valueBegin;
+		if( v[begin] == '{' )
+		{
+			for(; _NextMember(v, i, keyEnd, valueBegin, out_error); i = container.children.back().end)
+			{
+				_EditChild child = { i, _SkipOver(v, valueBegin, out_error), keyEnd, false };
+				if( child.end == JSONValue::npos ) { return 0; }
+				container.children.push_back(child);
+			}
+		}
+		else
+		{
+			for(; _NextElement(v, i, out_error); i = container.children.back().end)
+			{
+				_EditChild child = { i, _SkipOver(v, i, out_error), 0, false };
+				if( child.end == JSONValue::npos ) { return 0; }
+				container.children.push_back(child);
+			}
+		}
+		if( i == JSONValue::npos ) { return 0; }
+		container.kept = container.children.size();
+		containers.push_back(container);
+		return &containers.back();
+	}
+	inline void _EditAdd(std::vector<_EditRange>& ranges, size_t begin, size_t end, size_t head, size_t headLength, const JSONValue& text)
+	{
+		_EditRange r = { begin, end, head, headLength, text };
+		size_t k = ranges.size();
+		ranges.push_back(r);
+		for(; k > 0 && ranges[k-1].begin > begin; --k)//insertion sort, keeping edits at the same position in order
+			ranges[k] = ranges[k-1];
+		ranges[k] = r;
+	}
+	LOCJSON_FUNCTION bool ApplyEdits(const JSONValue& v, const JSONEdit* edits, int count, JSONDocument& out, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatApplyEdits);
+		out = JSONDocument();
+		if( count <= 0 ) { out = JSONDocument(v); return true; }
+		// Find the targets. A removal looks up the parent container, and the member itself in _EditWalk.
+		bool error = false;
+		std::vector<JSONPath> paths(count);
+		std::vector<JSONPathToken> removed(count);
+		for(int e=0; e<count && !error; ++e)
+		{
+			if( !CompilePath(edits[e].pointer, paths[e], error) ) { break; }
+			for(size_t t=0; t<paths[e].tokens.size(); ++t)
+				if( paths[e].tokens[t].wildcard ) { LOCJSON_EXCEPTION("Edits can't use wildcards"); error = true; }
+			if( edits[e].type == JSONEditRemove )
+			{
+				if( paths[e].tokens.empty() ) { LOCJSON_EXCEPTION("Can't remove the whole document"); error = true; break; }
+				removed[e] = paths[e].tokens.back();
+				paths[e].tokens.pop_back();
+			}
+		}
+		std::vector<JSONPathMatch> matches;
+		if( !error ) { QueryPaths(v, &paths[0], count, matches, error); }
+		std::vector<JSONValue> targets(count);
+		std::vector<bool> found(count, false);
+		for(size_t m=0; m<matches.size(); ++m)
+			if( !found[matches[m].path] ) { found[matches[m].path] = true; targets[matches[m].path] = matches[m].value; }
+		// Turn each edit into a range of the document to replace
+		std::vector<_EditRange> ranges;
+		std::vector<_EditContainer> containers;
+		containers.reserve(count);//_EditWalk returns pointers into this
+		JSONBuilder heads;
+		for(int e=0; e<count && !error; ++e)
+		{
+			if( !found[e] ) { LOCJSON_EXCEPTION("Edit target not found"); error = true; break; }
+			size_t begin = (size_t)(targets[e].data() - v.data()), end = begin + targets[e].size();
+			if( edits[e].type == JSONEditReplace )
+			{
+				_EditAdd(ranges, begin, end, 0, 0, edits[e].value);
+				continue;
+			}
+			if( v[begin] != '{' && v[begin] != '[' ) { LOCJSON_EXCEPTION("Edit target is not an object or array"); error = true; break; }
+			_EditContainer* c = _EditWalk(containers, v, begin, end, error);
+			if( !c ) { error = true; break; }
+			if( edits[e].type == JSONEditRemove )
+			{
+				// _KeyMatches compares lengths first, and only unescapes keys that contain a backslash
+				size_t child = 0;
+				if( v[begin] == '[' )
+					child = removed[e].index >= 0 && (size_t)removed[e].index < c->children.size() ? (size_t)removed[e].index : c->children.size();
+				else
+					while( child<c->children.size() && !_KeyMatches(v, c->children[child].begin, c->children[child].keyEnd, removed[e].name) )
+						++child;
+				if( child == c->children.size() ) { LOCJSON_EXCEPTION("Edit target not found"); error = true; break; }
+				if( c->children[child].removed ) { LOCJSON_EXCEPTION("Overlapping edits"); error = true; break; }
+				c->children[child].removed = true;
+				--c->kept;
+			}
+		}
+		// Removed children are dropped in runs, together with the comma that joined each run to a kept neighbour
+		for(size_t k=0; k<containers.size() && !error; ++k)
+		{
+			const std::vector<_EditChild>& children = containers[k].children;
+			for(size_t first=0; first<children.size(); ++first)
+			{
+				if( !children[first].removed ) { continue; }
+				size_t last = first;
+				while( last+1 < children.size() && children[last+1].removed )
+					++last;
+				if( last+1 < children.size() ) { _EditAdd(ranges, children[first].begin, children[last+1].begin, 0, 0, JSONValue()); }
+				else if( first > 0 )            { _EditAdd(ranges, children[first-1].end, children[last].end, 0, 0, JSONValue()); }
+				else                            { _EditAdd(ranges, children[first].begin, children[last].end, 0, 0, JSONValue()); }
+				first = last;
+			}
+		}
+		// Insertions go before the closing bracket, in the order they were given
+		for(int e=0; e<count && !error; ++e)
+		{
+			if( edits[e].type != JSONEditInsert ) { continue; }
+			size_t begin = (size_t)(targets[e].data() - v.data());
+			_EditContainer* c = _EditWalk(containers, v, begin, begin + targets[e].size(), error);
+			if( !c ) { error = true; break; }
+			bool object = v[begin] == '{';
+			if( object != (edits[e].key != 0) ) { LOCJSON_EXCEPTION(object ? "Inserting into an object needs a key" : "Inserting into an array doesn't take a key"); error = true; break; }
+			size_t head = heads.size;
+			if( c->kept++ ) { _Put(heads, ','); }
+			if( object ) { _WriteString(heads, edits[e].key, LOCJSON_STRLEN(edits[e].key)); _Put(heads, ':'); }
+			_EditAdd(ranges, c->end - 1, c->end - 1, head, heads.size - head, edits[e].value);
+		}
+		for(size_t r=1; r<ranges.size() && !error; ++r)
+			if( ranges[r].begin < ranges[r-1].end ) { LOCJSON_EXCEPTION("Overlapping edits"); error = true; }
+		if( error ) { out_error = true; return false; }
+		// Write the output in one pass
+		size_t length = v.size();
+		for(size_t r=0; r<ranges.size(); ++r)
+			length = length - (ranges[r].end - ranges[r].begin) + ranges[r].headLength + ranges[r].text.size();
+		out.resize(length);
+		Char* o = length ? &out[0] : 0;
+		size_t from = 0;
+		for(size_t r=0; r<ranges.size(); ++r)
+		{
+			const _EditRange& range = ranges[r];
+			memcpy(o, v.data() + from, (range.begin - from) * sizeof(Char)); o += range.begin - from;
+			if( range.headLength ) { memcpy(o, heads.data + range.head, range.headLength * sizeof(Char)); o += range.headLength; }
+			if( !range.text.empty() ) { memcpy(o, range.text.data(), range.text.size() * sizeof(Char)); o += range.text.size(); }
+			from = range.end;
+		}
+		if( from < v.size() ) { memcpy(o, v.data() + from, (v.size() - from) * sizeof(Char)); }
+		return true;
+	}
+
+	struct _Validator
+	{
+		const Char* p;
+		size_t      i, n;
+		const char* message;
+	};
+	inline bool _Invalid(_Validator& s, const char* message)
+	{
+		LOCJSON_EXCEPTION(message);
+		s.message = message;
+		return false;
+	}
+	inline void _ValidateWhitespace(_Validator& s)
+	{
+		while( s.i < s.n && _In(s.p[s.i], ' ', '\t', '\r', '\n') ) { ++s.i; }
+	}
+	inline bool _ValidateString(_Validator& s)
+	{
+		const Char* p = s.p;
+		size_t i = s.i + 1, n = s.n;
+		for(;;)
+		{
+#if defined(LOCJSON_SSE2)
+			if( sizeof(Char) == 1 )
+			{
+				//skip 16 at a time while there are no quotes, backslashes, control characters or non-ASCII bytes
+				//(the signed compare against 0x20 catches both control characters and bytes >= 0x80)
+				const __m128i quote = _mm_set1_epi8('"'), slash = _mm_set1_epi8('\\'), space = _mm_set1_epi8(0x20);
+				for(; i+16 <= n; i += 16)
+				{
+					__m128i x = _mm_loadu_si128((const __m128i*)(p+i));
+					unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmplt_epi8(x, space), _mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, slash))));
+					if( mask ) { i += _TrailingZeros(mask); break; }
+				}
+			}
+#endif
+			if( i >= n ) { s.i = i; return _Invalid(s, "Unterminated string"); }
+			UInt32 c = sizeof(Char) == 1 ? (UInt32)(unsigned char)p[i] : (UInt32)p[i];
+			if( c == '"' ) { s.i = i+1; return true; }
+			if( c == '\\' )
+			{
+				s.i = i;
+				if( i+1 >= n ) { return _Invalid(s, "Unterminated string"); }
+				switch( p[i+1] )
+				{
+				case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't': i += 2; continue;
+				case 'u':
+					for(size_t j=i+2; j<i+6; ++j)
+						if( j >= n || _HexDigit(p[j]) < 0 ) { return _Invalid(s, "Invalid \\u escape sequence"); }
+					i += 6;
+					continue;
+				}
+				return _Invalid(s, "Invalid escape sequence");
+			}
+			if( c < 0x20 ) { s.i = i; return _Invalid(s, "Control character in string"); }
+			if( c < 0x80 || sizeof(Char) > 1 ) { ++i; continue; }
+			size_t length;
+			UInt32 cp, minimum;
+			if(      (c & 0xE0) == 0xC0 ) { length = 2; cp = c & 0x1F; minimum = 0x80; }
+			else if( (c & 0xF0) == 0xE0 ) { length = 3; cp = c & 0x0F; minimum = 0x800; }
+			else if( (c & 0xF8) == 0xF0 ) { length = 4; cp = c & 0x07; minimum = 0x10000; }
+			else { s.i = i; return _Invalid(s, "Invalid UTF-8"); }
+			for(size_t k=1; k<length; ++k)
+			{
+				UInt32 b = i+k < n ? (UInt32)(unsigned char)p[i+k] : 0;
+				if( (b & 0xC0) != 0x80 ) { s.i = i; return _Invalid(s, "Invalid UTF-8"); }
+				cp = (cp << 6) | (b & 0x3F);
+			}
+			if( cp < minimum || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000) ) { s.i = i; return _Invalid(s, "Invalid UTF-8"); }
+			i += length;
+		}
+	}
+	inline bool _ValidateNumber(_Validator& s)
+	{
+		const Char* p = s.p;
+		size_t i = s.i, n = s.n;
+		if( p[i] == '-' ) { ++i; }
+		if( i >= n || p[i] < '0' || p[i] > '9' ) { s.i = i; return _Invalid(s, "Invalid number"); }
+		if( p[i] == '0' ) { ++i; }
+		else { while( i < n && p[i] >= '0' && p[i] <= '9' ) { ++i; } }
+		if( i < n && p[i] == '.' )
+		{
+			if( ++i >= n || p[i] < '0' || p[i] > '9' ) { s.i = i; return _Invalid(s, "Invalid number"); }
+			while( i < n && p[i] >= '0' && p[i] <= '9' ) { ++i; }
+		}
+		if( i < n && (p[i] == 'e' || p[i] == 'E') )
+		{
+			if( ++i < n && (p[i] == '+' || p[i] == '-') ) { ++i; }
+			if( i >= n || p[i] < '0' || p[i] > '9' ) { s.i = i; return _Invalid(s, "Invalid number"); }
+			while( i < n && p[i] >= '0' && p[i] <= '9' ) { ++i; }
+		}
+		s.i = i;
+		return true;
+	}
+	inline bool _ValidateLiteral(_Validator& s, const char* literal, size_t length)
+	{
+		for(size_t k=0; k<length; ++k)
+			if( s.i+k >= s.n || s.p[s.i+k] != (Char)literal[k] ) { s.i += k; return _Invalid(s, "Invalid literal"); }
+		s.i += length;
+		return true;
+	}
+	// Validates an object key and the following ':', leaving s.i on the value
+	inline bool _ValidateKey(_Validator& s)
+	{
+		_ValidateWhitespace(s);
+		if( s.i >= s.n || s.p[s.i] != '"' ) { return _Invalid(s, "Expected a key"); }
+		if( !_ValidateString(s) ) { return false; }
+		_ValidateWhitespace(s);
+		if( s.i >= s.n || s.p[s.i] != ':' ) { return _Invalid(s, "Expected ':'"); }
+		++s.i;
+		return true;
+	}
+	inline bool _Validate(_Validator& s)
+	{
+		std::vector<char> stack;//the open brackets
+		for(;;)
+		{
+			//a value
+			_ValidateWhitespace(s);
+			if( s.i >= s.n ) { return _Invalid(s, "Expected a value"); }
+			Char c = s.p[s.i];
+			if( c == '{' || c == '[' )
+			{
+				stack.push_back((char)c);
+				++s.i;
+				_ValidateWhitespace(s);
+				if( s.i < s.n && s.p[s.i] == (c == '{' ? '}' : ']') ) { stack.pop_back(); ++s.i; }
+				else if( c == '[' ) { continue; }
+				else if( !_ValidateKey(s) ) { return false; }
+				else { continue; }
+			}
+			else if( c == '"' ) { if( !_ValidateString(s) ) { return false; } }
+			else if( c == 't' ) { if( !_ValidateLiteral(s, "true", 4) ) { return false; } }
+			else if( c == 'f' ) { if( !_ValidateLiteral(s, "false", 5) ) { return false; } }
+			else if( c == 'n' ) { if( !_ValidateLiteral(s, "null", 4) ) { return false; } }
+			else if( c == '-' || (c >= '0' && c <= '9') ) { if( !_ValidateNumber(s) ) { return false; } }
+			else { return _Invalid(s, "Expected a value"); }
+			//what follows a value: separators, closing brackets, or the end of the document
+			for(;;)
+			{
+				_ValidateWhitespace(s);
+				if( stack.empty() )
+					return s.i == s.n ? true : _Invalid(s, "Unexpected text after the document");
+				if( s.i >= s.n ) { return _Invalid(s, stack.back() == '{' ? "Unterminated object" : "Unterminated array"); }
+				c = s.p[s.i];
+				if( c == ',' )
+				{
+					++s.i;
+					if( stack.back() == '{' && !_ValidateKey(s) ) { return false; }
+					break;
+				}
+				if( c != '}' && c != ']' ) { return _Invalid(s, "Expected ',' or a closing bracket"); }
+				if( stack.back() != (c == '}' ? '{' : '[') ) { return _Invalid(s, "Mismatched brackets"); }
+				stack.pop_back();
+				++s.i;
+			}
+		}
+	}
+	LOCJSON_FUNCTION bool Validate(const JSONValue& doc, JSONTrusted& out_root, JSONParseError& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatValidate);
+		_Validator s = { doc.data(), 0, doc.size(), 0 };
+		out_error = JSONParseError();
+		bool valid = _Validate(s);
+		LOCJSON_STAT_SCANNED(s.i < s.n ? s.i : s.n);
+		if( valid )
+		{
+			size_t begin = 0;
+			while( _In(doc[begin], ' ', '\t', '\r', '\n') ) { ++begin; }
+			out_root = JSONTrusted(doc.substr(begin));
+			return true;
+		}
+		out_root = JSONTrusted();
+		out_error.message = s.message;
+		out_error.offset = s.i;
+		out_error.line = 1;
+		size_t lineBegin = 0;
+		for(size_t i=0; i<s.i && i<s.n; ++i)
+			if( s.p[i] == '\n' ) { ++out_error.line; lineBegin = i+1; }
+		out_error.column = s.i - lineBegin + 1;
+		return false;
+	}
+
+	// Trusted accessors. The text has been validated, so values are skipped by tracking only
+	// strings and bracket depth, and separators are skipped without being checked.
+	inline size_t _TrustedSkip(const JSONValue& v, size_t i)
+	{
+		bool error = false;
+		return SkipSubtree(v, i, error);
+	}
+	inline size_t _TrustedNext(const JSONValue& v, size_t i)
+	{
+		return _FindFirstNotOf<',',':',' ','\t','\r','\n'>(v, i);
+	}
+	LOCJSON_FUNCTION JSONTrusted LookupValue(const JSONTrusted& t, const Char* field)
+	{
+		const JSONValue& v = t.value;
+		if( v.empty() || v[0] != '{' ) { return JSONTrusted(); }
+		size_t fieldLen = LOCJSON_STRLEN(field);
+		for(size_t i = _TrustedNext(v, 1); v[i] == '"'; )
+		{
+			size_t keyEnd = _TrustedSkip(v, i);
+			size_t valueBegin = _TrustedNext(v, keyEnd);
+			size_t valueEnd = _TrustedSkip(v, valueBegin);
+			if( keyEnd-i-2 == fieldLen && 0 == v.compare(i+1, fieldLen, field) )
+				return JSONTrusted(v.substr(valueBegin, valueEnd - valueBegin));
+			i = _TrustedNext(v, valueEnd);
+		}
+		return JSONTrusted();
+	}
+	LOCJSON_FUNCTION int ArraySize(const JSONTrusted& t)
+	{
+		const JSONValue& v = t.value;
+		if( v.empty() || v[0] != '[' ) { return 0; }
+		int count = 0;
+		for(size_t i = _TrustedNext(v, 1); v[i] != ']'; i = _TrustedNext(v, _TrustedSkip(v, i)))
+			++count;
+		return count;
+	}
+	LOCJSON_FUNCTION JSONTrusted IndexArray(const JSONTrusted& t, int index)
+	{
+		const JSONValue& v = t.value;
+		if( v.empty() || v[0] != '[' || index < 0 ) { return JSONTrusted(); }
+		for(size_t i = _TrustedNext(v, 1); v[i] != ']'; i = _TrustedNext(v, _TrustedSkip(v, i)))
+			if( index-- == 0 ) { return JSONTrusted(v.substr(i, _TrustedSkip(v, i) - i)); }
+		return JSONTrusted();
+	}
+	// Integers without a fraction or exponent, and with at most 18 digits, can't overflow an Int64 and
+	// are converted directly. Anything else goes through the checked conversion.
+	inline bool _TrustedInteger(const JSONValue& v, bool& out_negative, UInt64& out_magnitude)
+	{
+		size_t i = 0, n = v.size();
+		out_negative = n && v[0] == '-';
+		if( out_negative ) { ++i; }
+		UInt64 value = 0;
+		size_t start = i;
+		for(; i<n && v[i] >= '0' && v[i] <= '9'; ++i)
+			value = value*10 + (UInt64)(v[i] - '0');
+		if( i == start || i - start > 18 || (i < n && (v[i] == '.' || v[i] == 'e' || v[i] == 'E')) ) { return false; }
+		out_magnitude = value;
+		return true;
+	}
+	LOCJSON_FUNCTION Int64 AsInt64(const JSONTrusted& t)
+	{
+		bool negative, error = false; UInt64 magnitude;
+		if( _TrustedInteger(t.value, negative, magnitude) ) { return negative ? -(Int64)magnitude : (Int64)magnitude; }
+		Int64 value = AsInt64(t.value, error);
+		return error ? 0 : value;
+	}
+	LOCJSON_FUNCTION UInt64 AsUInt64(const JSONTrusted& t)
+	{
+		bool negative, error = false; UInt64 magnitude;
+		if( _TrustedInteger(t.value, negative, magnitude) ) { return negative && magnitude ? 0 : magnitude; }
+		UInt64 value = AsUInt64(t.value, error);
+		return error ? 0 : value;
+	}
+	LOCJSON_FUNCTION Int32 AsInt32(const JSONTrusted& t)
+	{
+		Int64 value = AsInt64(t);
+		return value >= -2147483647-1 && value <= 2147483647 ? (Int32)value : 0;
+	}
+	LOCJSON_FUNCTION UInt32 AsUInt32(const JSONTrusted& t)
+	{
+		UInt64 value = AsUInt64(t);
+		return value <= 0xFFFFFFFFu ? (UInt32)value : 0;
+	}
+	LOCJSON_FUNCTION double AsDouble(const JSONTrusted& t)
+	{
+		bool error = false;
+		double value = AsDouble(t.value, error);
+		return error ? 0 : value;
+	}
+	LOCJSON_FUNCTION bool AsBool(const JSONTrusted& t)   { return !t.value.empty() && t.value[0] == 't'; }
+	LOCJSON_FUNCTION bool IsNull(const JSONTrusted& t)   { return !t.value.empty() && t.value[0] == 'n'; }
+	LOCJSON_FUNCTION bool IsArray(const JSONTrusted& t)  { return !t.value.empty() && t.value[0] == '['; }
+	LOCJSON_FUNCTION bool IsObject(const JSONTrusted& t) { return !t.value.empty() && t.value[0] == '{'; }
+	LOCJSON_FUNCTION String AsString(const JSONTrusted& t)
+	{
+		const JSONValue& v = t.value;
+		if( v.empty() || v[0] != '"' ) { return String(); }
+		size_t end = _TrustedSkip(v, 0);
+		if( _ScanRange<'\\'>(v.data(), 1, end - 1, false) == JSONValue::npos ) { return String(v.data() + 1, end - 2); }
+		bool error = false;
+		return AsString(v.substr(0, end), error);
+	}
+	LOCJSON_FUNCTION Int32  LookupInt32(const JSONTrusted& t, const Char* field)  { return AsInt32(LookupValue(t, field)); }
+	LOCJSON_FUNCTION UInt32 LookupUInt32(const JSONTrusted& t, const Char* field) { return AsUInt32(LookupValue(t, field)); }
+	LOCJSON_FUNCTION Int64  LookupInt64(const JSONTrusted& t, const Char* field)  { return AsInt64(LookupValue(t, field)); }
+	LOCJSON_FUNCTION UInt64 LookupUInt64(const JSONTrusted& t, const Char* field) { return AsUInt64(LookupValue(t, field)); }
+	LOCJSON_FUNCTION double LookupDouble(const JSONTrusted& t, const Char* field) { return AsDouble(LookupValue(t, field)); }
+	LOCJSON_FUNCTION bool   LookupBool(const JSONTrusted& t, const Char* field)   { return AsBool(LookupValue(t, field)); }
+	LOCJSON_FUNCTION String LookupString(const JSONTrusted& t, const Char* field) { return AsString(LookupValue(t, field)); }
+	LOCJSON_FUNCTION bool   HasField(const JSONTrusted& t, const Char* field)     { return !LookupValue(t, field).value.empty(); }
+
+	// Instrumentation. Each thread owns its counters and is their only writer, so counting is a relaxed
+	// load and store (no locked instructions), while GlobalStats can still read them from another thread.
+#if defined(LOCJSON_STATS)
+	struct _StatCounters
+	{
+		_StatCounters();
+		~_StatCounters();
+		std::atomic<UInt64> values[JSONStatFunctionCount][4]; // calls, bytesScanned, skips, allocations
+		std::atomic<UInt64> documents, documentBytes;
+		int current; // the innermost instrumented function
+	};
+	struct _StatRegistry
+	{
+# if !defined(LOCJSON_NO_THREADS)
+		std::mutex mutex;
+# endif
+		std::vector<_StatCounters*> threads;
+		JSONStats retired; // the counters of threads that have exited
+	};
+	inline _StatRegistry& _Registry() { static _StatRegistry* registry = new _StatRegistry; return *registry; }//never destroyed, as threads may exit during shutdown
+# if defined(LOCJSON_NO_THREADS)
+	struct _StatLock { explicit _StatLock(_StatRegistry&) {} };
+	inline _StatCounters& _ThreadCounters() { static _StatCounters counters; return counters; }
+# else
+	struct _StatLock { explicit _StatLock(_StatRegistry& r) : lock(r.mutex) {} std::lock_guard<std::mutex> lock; };
+	inline _StatCounters& _ThreadCounters() { static thread_local _StatCounters counters; return counters; }
+# endif
+	inline void _Bump(std::atomic<UInt64>& counter, UInt64 count) { counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed); }
+	inline JSONStats _ReadStats(const _StatCounters& c)
+	{
+		JSONStats stats;
+		for(int f=0; f<JSONStatFunctionCount; ++f)
+		{
+			stats.functions[f].calls        = c.values[f][0].load(std::memory_order_relaxed);
+			stats.functions[f].bytesScanned = c.values[f][1].load(std::memory_order_relaxed);
+			stats.functions[f].skips        = c.values[f][2].load(std::memory_order_relaxed);
+			stats.functions[f].allocations  = c.values[f][3].load(std::memory_order_relaxed);
+		}
+		stats.documents     = c.documents.load(std::memory_order_relaxed);
+		stats.documentBytes = c.documentBytes.load(std::memory_order_relaxed);
+		return stats;
+	}
+	inline void _AddStats(JSONStats& total, const JSONStats& s)
+	{
+		for(int f=0; f<JSONStatFunctionCount; ++f)
+		{
+			total.functions[f].calls        += s.functions[f].calls;
+			total.functions[f].bytesScanned += s.functions[f].bytesScanned;
+			total.functions[f].skips        += s.functions[f].skips;
+			total.functions[f].allocations  += s.functions[f].allocations;
+		}
+		total.documents     += s.documents;
+		total.documentBytes += s.documentBytes;
+	}
+	inline void _ClearCounters(_StatCounters& c)
+	{
+		for(int f=0; f<JSONStatFunctionCount; ++f)
+			for(int k=0; k<4; ++k)
+				c.values[f][k].store(0, std::memory_order_relaxed);
+		c.documents.store(0, std::memory_order_relaxed);
+		c.documentBytes.store(0, std::memory_order_relaxed);
+	}
+	LOCJSON_FUNCTION _StatCounters::_StatCounters() : current(JSONStatOther)
+	{
+		_ClearCounters(*this);
+		_StatRegistry& registry = _Registry();
+		_StatLock lock(registry);
+		registry.threads.push_back(this);
+	}
+	LOCJSON_FUNCTION _StatCounters::~_StatCounters()
+	{
+		_StatRegistry& registry = _Registry();
+		_StatLock lock(registry);
+		_AddStats(registry.retired, _ReadStats(*this));
+		for(size_t t=0; t<registry.threads.size(); ++t)
+			if( registry.threads[t] == this ) { registry.threads.erase(registry.threads.begin() + t); break; }
+	}
+	LOCJSON_FUNCTION int _StatEnter(int function)
+	{
+		_StatCounters& c = _ThreadCounters();
+		int previous = c.current;
+		c.current = function;
+		_Bump(c.values[function][0], 1);
+		return previous;
+	}
+	LOCJSON_FUNCTION void _StatLeave(int previous)                { _ThreadCounters().current = previous; }
+	LOCJSON_FUNCTION void _StatAdd(int counter, UInt64 count)     { _StatCounters& c = _ThreadCounters(); _Bump(c.values[c.current][counter], count); }
+	LOCJSON_FUNCTION void _StatDocument(size_t length)            { _StatCounters& c = _ThreadCounters(); _Bump(c.documents, 1); _Bump(c.documentBytes, length); }
+#endif
+	LOCJSON_FUNCTION JSONStats ThreadStats()
+	{
+#if defined(LOCJSON_STATS)
+		return _ReadStats(_ThreadCounters());
+#else
+		return JSONStats();
+#endif
+	}
+	LOCJSON_FUNCTION JSONStats GlobalStats()
+	{
+		JSONStats total;
+#if defined(LOCJSON_STATS)
+		_StatRegistry& registry = _Registry();
+		_StatLock lock(registry);
+		total = registry.retired;
+		for(size_t t=0; t<registry.threads.size(); ++t)
+			_AddStats(total, _ReadStats(*registry.threads[t]));
+#endif
+		return total;
+	}
+	LOCJSON_FUNCTION void ResetThreadStats()
+	{
+#if defined(LOCJSON_STATS)
+		_ClearCounters(_ThreadCounters());
+#endif
+	}
+	LOCJSON_FUNCTION JSONStats StatsDifference(const JSONStats& after, const JSONStats& before)
+	{
+		JSONStats d = after;
+		for(int f=0; f<JSONStatFunctionCount; ++f)
+		{
+			d.functions[f].calls        -= before.functions[f].calls;
+			d.functions[f].bytesScanned -= before.functions[f].bytesScanned;
+			d.functions[f].skips        -= before.functions[f].skips;
+			d.functions[f].allocations  -= before.functions[f].allocations;
+		}
+		d.documents     -= before.documents;
+		d.documentBytes -= before.documentBytes;
+		return d;
+	}
+	LOCJSON_FUNCTION double StatsAmplification(const JSONStats& stats)
+	{
+		UInt64 scanned = 0;
+		for(int f=0; f<JSONStatFunctionCount; ++f)
+			scanned += stats.functions[f].bytesScanned;
+		return stats.documentBytes ? (double)scanned / (double)stats.documentBytes : 0.0;
+	}
+	LOCJSON_FUNCTION const char* StatsFunctionName(JSONStatFunction function)
+	{
+		static const char* const names[JSONStatFunctionCount] = {
+			"LookupValue", "LookupFields", "ArraySize", "IndexArray", "IterateArray", "IterateObject", "AsString", "Parse (indexed)",
+			"Validate", "QueryPaths", "ParseSax", "SplitArray/Lines", "NextRecord", "NextValue", "DecodeObject", "ApplyEdits", "Minify", "other" };
+		return function >= 0 && function < JSONStatFunctionCount ? names[function] : "";
+	}
+	LOCJSON_FUNCTION void PrintStats(const JSONStats& stats, FILE* out)
+	{
+		fprintf(out, "%-18s %12s %16s %12s %12s\n", "function", "calls", "bytes scanned", "skips", "allocations");
+		for(int f=0; f<JSONStatFunctionCount; ++f)
+		{
+			const JSONCallStats& c = stats.functions[f];
+			if( !c.calls && !c.bytesScanned && !c.skips && !c.allocations ) { continue; }
+			fprintf(out, "%-18s %12llu %16llu %12llu %12llu\n", StatsFunctionName((JSONStatFunction)f),
+			        (unsigned long long)c.calls, (unsigned long long)c.bytesScanned, (unsigned long long)c.skips, (unsigned long long)c.allocations);
+		}
+		fprintf(out, "%llu documents, %llu bytes, %.2f bytes scanned per byte\n", (unsigned long long)stats.documents, (unsigned long long)stats.documentBytes, StatsAmplification(stats));
+	}
+#else
+	LOCJSON_FUNCTION size_t _SaxSkip(const JSONValue& v, size_t i, bool& out_error);
+	LOCJSON_FUNCTION bool   _SaxNextElement(const JSONValue& v, size_t& i, bool& out_error);
+	LOCJSON_FUNCTION bool   _SaxNextMember(const JSONValue& v, size_t& i, size_t& keyEnd, size_t& valueBegin, bool& out_error);
+	LOCJSON_FUNCTION size_t _SaxScalar(const JSONValue& v, size_t i, bool& out_error);
+	LOCJSON_FUNCTION void _ParallelFor(size_t count, int threads, void (*fn)(void* context, size_t begin, size_t end), void* context);
+	LOCJSON_FUNCTION JSONBindTable _BuildBindTable(const JSONBoundField* fields, int count);
+	LOCJSON_FUNCTION bool _DecodeObject(const JSONValue& v, void* object, const JSONBoundField* fields, int count, const JSONBindTable& table, bool& out_error, JSONBindReport* out_report, size_t* out_end);
+#endif
+	// Integers of any type (e.g. `long long` where Int64 is `long`) go through the AddValue of the same size and sign
+	template<class T, bool = std::is_integral<T>::value && !std::is_same<T, bool>::value> struct _BuilderValue { typedef T Type; };
+	template<class T> struct _BuilderValue<T, true>
+	{
+		typedef typename std::conditional<(sizeof(T) > 4), Int64, Int32>::type   Signed;
+		typedef typename std::conditional<(sizeof(T) > 4), UInt64, UInt32>::type Unsigned;
+		typedef typename std::conditional<std::is_signed<T>::value, Signed, Unsigned>::type Type;
+	};
+	inline void                      _AddValues(JSONBuilder&)                                           {}
+	template<class T, class... Args> void _AddValues(JSONBuilder& b, T arg0, Args... args)               { AddValue(b, (typename _BuilderValue<T>::Type)arg0); _AddValues(b, args...); }
+	template<class... Args>          void AddArray(JSONBuilder& b, const Char* key, Args... args)       { BeginArray(b, key); _AddValues(b, args...); EndArray(b); }
+
+	template<class F> struct _ForEachContext
+	{
+		const std::vector<JSONValue>* values;
+		F* fn;
+		static void Run(void* context, size_t begin, size_t end)
+		{
+			_ForEachContext& c = *(_ForEachContext*)context;
+			for(size_t i=begin; i<end; ++i)
+				(*c.fn)(i, (*c.values)[i]);
+		}
+	};
+	template<class F> void ParallelForEach(const std::vector<JSONValue>& values, F fn, int threads)
+	{
+		_ForEachContext<F> context = { &values, &fn };
+		_ParallelFor(values.size(), threads, &_ForEachContext<F>::Run, &context);
+	}
+
+	template<class T> bool _DecodeStruct(const JSONValue& v, T& out, bool& out_error, JSONBindReport* out_report, size_t* out_end)
+	{
+		int count = 0;
+		const JSONBoundField* fields = JSONBinding<T>::Fields(count);
+		static const JSONBindTable table = _BuildBindTable(fields, count);
+		return _DecodeObject(v, &out, fields, count, table, out_error, out_report, out_end);
+	}
+	// Each _DecodeInto returns the end of the value it decoded (or npos), so the enclosing object carries on from there
+	inline size_t                    _DecodeInto(const JSONValue& v, Int32& out, bool& out_error)       { size_t end = _SaxSkip(v, 0, out_error); out = AsInt32(v.substr(0, end), out_error); return end; }
+	inline size_t                    _DecodeInto(const JSONValue& v, UInt32& out, bool& out_error)      { size_t end = _SaxSkip(v, 0, out_error); out = AsUInt32(v.substr(0, end), out_error); return end; }
+	inline size_t                    _DecodeInto(const JSONValue& v, Int64& out, bool& out_error)       { size_t end = _SaxSkip(v, 0, out_error); out = AsInt64(v.substr(0, end), out_error); return end; }
+	inline size_t                    _DecodeInto(const JSONValue& v, UInt64& out, bool& out_error)      { size_t end = _SaxSkip(v, 0, out_error); out = AsUInt64(v.substr(0, end), out_error); return end; }
+	inline size_t                    _DecodeInto(const JSONValue& v, double& out, bool& out_error)      { size_t end = _SaxSkip(v, 0, out_error); out = AsDouble(v.substr(0, end), out_error); return end; }
+	inline size_t                    _DecodeInto(const JSONValue& v, bool& out, bool& out_error)        { size_t end = _SaxSkip(v, 0, out_error); out = AsBool(v.substr(0, end), out_error); return end; }
+	inline size_t                    _DecodeInto(const JSONValue& v, String& out, bool& out_error)      { size_t end = _SaxSkip(v, 0, out_error); out = AsString(v.substr(0, end), out_error); return end; }
+	template<class T>                size_t _DecodeInto(const JSONValue& v, T& out, bool& out_error)      { size_t end; _DecodeStruct(v, out, out_error, 0, &end); return end; }
+	template<class T>                size_t _DecodeInto(const JSONValue& v, std::vector<T>& out, bool& out_error)
+	{
+		out.clear();
+		if( v.length() < 1 || v[0] != '[' ) { LOCJSON_EXCEPTION("Decoding non-array value"); out_error = true; return JSONValue::npos; }
+		size_t i = 1;
+		while( _SaxNextElement(v, i, out_error) )
+		{
+			out.push_back(T());
+			size_t end = _DecodeInto(v.substr(i), out.back(), out_error);
+			if( end == JSONValue::npos ) { return end; }
+			i += end;
+		}
+		return i == JSONValue::npos ? i : i+1;
+	}
+	template<class T, class M, M T::*member> size_t _DecodeMember(const JSONValue& v, void* object, bool& out_error) { return _DecodeInto(v, static_cast<T*>(object)->*member, out_error); }
+	template<class T> bool DecodeObject(const JSONValue& v, T& out, bool& out_error, JSONBindReport* out_report) { return _DecodeStruct(v, out, out_error, out_report, 0); }
+
+	// Walks the document with an explicit stack of open containers, so hostile nesting can't overflow the call stack.
+	template<class Handler> bool ParseSax(const JSONValue& v, Handler& handler, bool& out_error)
+	{
+		LOCJSON_STAT_SCOPE(JSONStatParseSax);
+		size_t i = v.find_first_not_of(LOCJSON_LITERAL(" \t\r\n"));
+		if( i == JSONValue::npos ) { LOCJSON_EXCEPTION("Empty document"); out_error = true; return false; }
+		_Nesting nesting;
+		JSONSaxResult result;
+		bool error = false;
+		size_t keyEnd, valueBegin;
+		for(;;)
+		{
+			//`i` is at the start of a value
+			switch( v[i] )
+			{
+			case '{':
+			case '[':
+				result = v[i] == '{' ? handler.StartObject() : handler.StartArray();
+				if( result == JSONStop ) { out_error |= error; return false; }
+				if( result == JSONSkip ) { i = _SaxSkip(v, i, error); break; }
+				if( !nesting.Push(v[i] == '{') ) { LOCJSON_EXCEPTION("Nesting too deep"); out_error = true; return false; }
+				++i;
+				break;
+			default:
+				{
+					size_t end = _SaxScalar(v, i, error);
+					if( end == JSONValue::npos ) { out_error = true; return false; }//malformed values never reach the handler
+					switch( v[i] )
+					{
+					case '"': result = handler.String(StringView(v.data() + i + 1, end - i - 2)); break;
+					case 't':
+					case 'f': result = handler.Bool(v[i] == 't'); break;
+					case 'n': result = handler.Null(); break;
+					default:  result = handler.Number(v.substr(i, end - i)); break;
+					}
+					if( result == JSONStop ) { out_error |= error; return false; }
+					i = end;
+				}
+			}
+			//move on to the next value, closing the containers that end first
+			for(;;)
+			{
+				if( nesting.depth == 0 )
+				{
+					if( !error && v.find_first_not_of(LOCJSON_LITERAL(" \t\r\n"), i) != JSONValue::npos ) { LOCJSON_EXCEPTION("Unexpected text after the document"); error = true; }
+					out_error |= error;
+					return !error;
+				}
+				if( !nesting.InObject() )
+				{
+					if( _SaxNextElement(v, i, error) ) { break; }
+				}
+				else if( _SaxNextMember(v, i, keyEnd, valueBegin, error) )
+				{
+					result = handler.Key(StringView(v.data() + i + 1, keyEnd - i - 2));
+					if( result == JSONStop ) { out_error |= error; return false; }
+					if( result == JSONContinue ) { i = valueBegin; break; }
+					i = _SaxSkip(v, valueBegin, error);
+					continue;
+				}
+				if( i == JSONValue::npos ) { out_error |= error; return false; }
+				result = nesting.InObject() ? handler.EndObject() : handler.EndArray();
+				--nesting.depth;
+				++i;
+				if( result == JSONStop ) { out_error |= error; return false; }
+			}
+		}
+	}
+}
+
+// Binds a struct's members to JSON keys for use with locjson::DecodeObject. Use at global scope, e.g.
+//   LOCJSON_BIND_BEGIN(Person)
+//     LOCJSON_BIND_FIELD(id)
+//     LOCJSON_BIND_KEY(address, "addr")
+//   LOCJSON_BIND_END()
+// Members may be Int32, UInt32, Int64, UInt64, double, bool, String, other bound structs, or std::vectors of these. Up to 64 fields per struct.
+#define LOCJSON_BIND_BEGIN(T) namespace locjson { template<> struct JSONBinding<T> { typedef T Type; static const JSONBoundField* Fields(int& out_count) { static constexpr JSONBoundField fields[] = {
+#define LOCJSON_BIND_KEY(member, key) { LOCJSON_LITERAL(key), sizeof(LOCJSON_LITERAL(key))/sizeof(::locjson::Char)-1, ::locjson::_HashKey(LOCJSON_LITERAL(key), sizeof(LOCJSON_LITERAL(key))/sizeof(::locjson::Char)-1), &::locjson::_DecodeMember<Type, decltype(Type::member), &Type::member> },
+#define LOCJSON_BIND_FIELD(member) LOCJSON_BIND_KEY(member, #member)
+#define LOCJSON_BIND_END() }; static_assert(sizeof(fields)/sizeof(fields[0]) <= 64, "Too many bound fields"); static_assert(::locjson::_KeysUnique(fields, sizeof(fields)/sizeof(fields[0])), "Key bound twice"); out_count = (int)(sizeof(fields)/sizeof(fields[0])); return fields; } }; }
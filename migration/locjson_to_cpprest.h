@@ -15,23 +15,41 @@ namespace locjson {
 
 	inline int32_t          LookupInt32(  const web::json::value& v, const wchar_t* field, bool& out_error) { return v.at(field).as_integer(); }
 	inline uint32_t         LookupUInt32( const web::json::value& v, const wchar_t* field, bool& out_error) { return (uint32_t)v.at(field).as_integer(); }
+	inline int64_t          LookupInt64(  const web::json::value& v, const wchar_t* field, bool& out_error) { return v.at(field).as_number().to_int64(); }
+	inline uint64_t         LookupUInt64( const web::json::value& v, const wchar_t* field, bool& out_error) { return v.at(field).as_number().to_uint64(); }
+	inline double           LookupDouble( const web::json::value& v, const wchar_t* field, bool& out_error) { return v.at(field).as_double(); }
+	inline bool             LookupBool(   const web::json::value& v, const wchar_t* field, bool& out_error) { return v.at(field).as_bool(); }
 	inline std::wstring     LookupString( const web::json::value& v, const wchar_t* field, bool& out_error) { return v.at(field).as_string(); }
 	inline web::json::value LookupValue(  const web::json::value& v, const wchar_t* field, bool& out_error) { return v.at(field); }
 	inline web::json::array LookupArray(  const web::json::value& v, const wchar_t* field, bool& out_error) { return v.at(field).as_array(); }
 	inline bool             HasField(     const web::json::value& v, const wchar_t* field, bool& out_error) { return v.has_field(field); }
 	inline bool             HasArrayField(const web::json::value& v, const wchar_t* field, bool& out_error) { return v.has_array_field(field); }
+	inline bool             HasNullField( const web::json::value& v, const wchar_t* field, bool& out_error) { return v.has_field(field) && v.at(field).is_null(); }
 	inline int32_t          AsInt32(      const web::json::value& v,                       bool& out_error) { return v.as_integer(); }
 	inline uint32_t         AsUInt32(     const web::json::value& v,                       bool& out_error) { return (uint32_t)v.as_integer(); }
+	inline int64_t          AsInt64(      const web::json::value& v,                       bool& out_error) { return v.as_number().to_int64(); }
+	inline uint64_t         AsUInt64(     const web::json::value& v,                       bool& out_error) { return v.as_number().to_uint64(); }
+	inline double           AsDouble(     const web::json::value& v,                       bool& out_error) { return v.as_double(); }
+	inline bool             AsBool(       const web::json::value& v,                       bool& out_error) { return v.as_bool(); }
+	inline bool             IsNull(       const web::json::value& v,                       bool& out_error) { return v.is_null(); }
 	inline std::wstring     AsString(     const web::json::value& v,                       bool& out_error) { return v.as_string(); }
 	inline web::json::array AsArray(      const web::json::value& v,                       bool& out_error) { return v.as_array(); }
 	inline bool             IsArray(      const web::json::value& v,                       bool& out_error) { return v.is_array(); }
 	inline bool             IsObject(     const web::json::value& v,                       bool& out_error) { return v.is_object(); }
 	inline int              ArraySize(    const web::json::array& a,                       bool& out_error) { return (int)a.size(); }
 	inline web::json::value IndexArray(   const web::json::array& a, int index,            bool& out_error) { return a.at((size_t)index); }
+	inline web::json::array IterateArray( web::json::array a,                              bool& out_error) { return a; } // by value: callers pass temporaries from LookupArray
 
 	inline void BeginObject(web::json::value&) {}
 	inline void EndObject(web::json::value&){}
 	inline void AddString(web::json::value& root, const wchar_t* key, const wchar_t* value) { root[key] = web::json::value::string(value); }
+	inline void AddInt32( web::json::value& root, const wchar_t* key, int32_t value)        { root[key] = web::json::value::number(value); }
+	inline void AddUInt32(web::json::value& root, const wchar_t* key, uint32_t value)       { root[key] = web::json::value::number(value); }
+	inline void AddInt64( web::json::value& root, const wchar_t* key, int64_t value)        { root[key] = web::json::value::number(value); }
+	inline void AddUInt64(web::json::value& root, const wchar_t* key, uint64_t value)       { root[key] = web::json::value::number(value); }
+	inline void AddDouble(web::json::value& root, const wchar_t* key, double value)         { root[key] = web::json::value::number(value); }
+	inline void AddBool(  web::json::value& root, const wchar_t* key, bool value)           { root[key] = web::json::value::boolean(value); }
+	inline void AddNull(  web::json::value& root, const wchar_t* key)                       { root[key] = web::json::value::null(); }
 	inline void AddValues(int idx, web::json::value& ar)                                    {}
 	inline void AddValues(int idx, web::json::value& ar, const wchar_t* arg)                { ar[idx] = web::json::value::string(arg); }
 	template<class T> void AddValues(int idx, web::json::value& ar, T arg)                  { ar[idx] = web::json::value::number(arg); }
@@ -18,13 +18,23 @@ namespace locjson {
 	inline const rapidjson::Value& Parse(const rapidjson::Document& d) { return d; }
 	inline int32_t                 LookupInt32(  const rapidjson::Value& v, const char* field, bool& out_error) { return v[field].GetInt(); }
 	inline uint32_t                LookupUInt32( const rapidjson::Value& v, const char* field, bool& out_error) { return (uint32_t)v[field].GetInt(); }
+	inline int64_t                 LookupInt64(  const rapidjson::Value& v, const char* field, bool& out_error) { return v[field].GetInt64(); }
+	inline uint64_t                LookupUInt64( const rapidjson::Value& v, const char* field, bool& out_error) { return v[field].GetUint64(); }
+	inline double                  LookupDouble( const rapidjson::Value& v, const char* field, bool& out_error) { return v[field].GetDouble(); }
+	inline bool                    LookupBool(   const rapidjson::Value& v, const char* field, bool& out_error) { return v[field].GetBool(); }
 	inline const char*             LookupString( const rapidjson::Value& v, const char* field, bool& out_error) { return v[field].GetString(); }
 	inline const rapidjson::Value& LookupValue(  const rapidjson::Value& v, const char* field, bool& out_error) { return v[field]; }
 	inline const rapidjson::Value& LookupArray(  const rapidjson::Value& v, const char* field, bool& out_error) { return v[field]; }
 	inline bool                    HasField(     const rapidjson::Value& v, const char* field, bool& out_error) { return v.HasMember(field); }
 	inline bool                    HasArrayField(const rapidjson::Value& v, const char* field, bool& out_error) { return v[field].IsArray(); }
+	inline bool                    HasNullField( const rapidjson::Value& v, const char* field, bool& out_error) { return v[field].IsNull(); }
 	inline int32_t                 AsInt32(      const rapidjson::Value& v,                    bool& out_error) { return v.GetInt(); }
 	inline uint32_t                AsUInt32(     const rapidjson::Value& v,                    bool& out_error) { return (uint32_t)v.GetInt(); }
+	inline int64_t                 AsInt64(      const rapidjson::Value& v,                    bool& out_error) { return v.GetInt64(); }
+	inline uint64_t                AsUInt64(     const rapidjson::Value& v,                    bool& out_error) { return v.GetUint64(); }
+	inline double                  AsDouble(     const rapidjson::Value& v,                    bool& out_error) { return v.GetDouble(); }
+	inline bool                    AsBool(       const rapidjson::Value& v,                    bool& out_error) { return v.GetBool(); }
+	inline bool                    IsNull(       const rapidjson::Value& v,                    bool& out_error) { return v.IsNull(); }
 	inline const char*             AsString(     const rapidjson::Value& v,                    bool& out_error) { return v.GetString(); }
 	inline const rapidjson::Value& AsArray(      const rapidjson::Value& v,                    bool& out_error) { return v; }
 	inline bool                    IsArray(      const rapidjson::Value& v,                    bool& out_error) { return v.IsArray(); }
@@ -32,18 +42,36 @@ namespace locjson {
 
 	inline int                     ArraySize( const rapidjson::Value& v,            bool& out_error) { return v.Size(); }
 	inline const rapidjson::Value& IndexArray(const rapidjson::Value& v, int index, bool& out_error) { return v[index]; }
+	inline rapidjson::Value::ConstArray IterateArray(const rapidjson::Value& v,   bool& out_error) { return v.GetArray(); }
 
 	typedef JSONBuilder JSONBuilder;
 	inline void BeginObject(JSONBuilder& b)                                   { b.w.StartObject(); }
 	inline void EndObject(JSONBuilder& b)                                     { b.w.EndObject();}
+	inline void BeginObject(JSONBuilder& b, const char* key)                  { b.w.String(key); b.w.StartObject(); }
+	inline void BeginArray(JSONBuilder& b)                                    { b.w.StartArray(); }
+	inline void BeginArray(JSONBuilder& b, const char* key)                   { b.w.String(key); b.w.StartArray(); }
+	inline void EndArray(JSONBuilder& b)                                      { b.w.EndArray(); }
+	inline void Reset(JSONBuilder& b)                                         { b.buf.Clear(); b.w.Reset(b.buf); }
 	inline void AddString(JSONBuilder& b, const char* key, const char* value) { b.w.String(key); b.w.String(value); }
+	inline void AddInt32(JSONBuilder& b, const char* key, int32_t value)      { b.w.String(key); b.w.Int(value); }
+	inline void AddUInt32(JSONBuilder& b, const char* key, uint32_t value)    { b.w.String(key); b.w.Uint(value); }
+	inline void AddInt64(JSONBuilder& b, const char* key, int64_t value)      { b.w.String(key); b.w.Int64(value); }
+	inline void AddUInt64(JSONBuilder& b, const char* key, uint64_t value)    { b.w.String(key); b.w.Uint64(value); }
+	inline void AddDouble(JSONBuilder& b, const char* key, double value)      { b.w.String(key); b.w.Double(value); }
+	inline void AddBool(JSONBuilder& b, const char* key, bool value)          { b.w.String(key); b.w.Bool(value); }
+	inline void AddNull(JSONBuilder& b, const char* key)                      { b.w.String(key); b.w.Null(); }
+	inline void AddValue(JSONBuilder& b, const char* arg)                     { b.w.String(arg); }
+	inline void AddValue(JSONBuilder& b, int32_t arg)                         { b.w.Int(arg); }
+	inline void AddValue(JSONBuilder& b, uint32_t arg)                        { b.w.Uint(arg); }
+	inline void AddValue(JSONBuilder& b, int64_t arg)                         { b.w.Int64(arg); }
+	inline void AddValue(JSONBuilder& b, uint64_t arg)                        { b.w.Uint64(arg); }
+	inline void AddValue(JSONBuilder& b, double arg)                          { b.w.Double(arg); }
+	inline void AddValue(JSONBuilder& b, bool arg)                            { b.w.Bool(arg); }
+	inline void AddNull(JSONBuilder& b)                                       { b.w.Null(); }
 	inline void AddValues(JSONBuilder& ar)                                    {}
-	inline void AddValues(JSONBuilder& b, const char* arg)                    { b.w.String(arg); }
-	inline void AddValues(JSONBuilder& b, int32_t arg)                        { b.w.Int(arg); }
-	inline void AddValues(JSONBuilder& b, uint32_t arg)                       { b.w.Int(arg); }
 	template<class T, class... Args> void AddValues(JSONBuilder& b, T arg0, Args... args) 
 	{
-		AddValues(b, arg0);
+		AddValue(b, arg0);
 		AddValues(b, args...);
 	}
 	template<class... Args> void AddArray(JSONBuilder& b, const char* key, Args... args)